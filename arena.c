@@ -0,0 +1,76 @@
+// Arena allocator: many small objects in a few large blocks, released all at once
+/*
+ * arena.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "arena.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+
+// the header is padded, so the memory of a block starts aligned
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+Arena* arena_new(size_t block_size) {
+  Arena *a = (Arena *)malloc(sizeof(Arena));
+  if(!a) {
+    g_error("Arena can't be alloc'd");
+  }
+  a->block_size = block_size;
+  a->next = NULL;
+  a->end = NULL;
+  a->blocks = NULL;
+  a->allocated = 0;
+  return a;
+}
+
+void* arena_alloc_block(Arena *a, size_t size) {
+  size_t block_size = MAX(size, a->block_size);
+  ArenaBlock *b = (ArenaBlock *)malloc(ARENA_HEADER + block_size);
+  if(!b) {
+    g_error("Failed to alloc an arena block of %zu bytes", block_size);
+  }
+  b->size = block_size;
+  char *memory = (char *)b + ARENA_HEADER;
+  if(size > a->block_size && a->blocks) {
+    // an object larger than a block gets its own, behind the current one,
+    // so the free space left in the current block isn't wasted
+    b->next = a->blocks->next;
+    a->blocks->next = b;
+  }
+  else {
+    b->next = a->blocks;
+    a->blocks = b;
+    a->next = memory + size;
+    a->end = memory + block_size;
+  }
+  a->allocated += size;
+  return memory;
+}
+
+void arena_free(Arena *a) {
+  ArenaBlock *b, *next;
+  for(b = a->blocks; b != NULL; b = next) {
+    next = b->next;
+    free(b);
+  }
+  free(a);
+}
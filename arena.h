@@ -0,0 +1,64 @@
+// Arena allocator: many small objects in a few large blocks, released all at once (header file)
+/*
+ * arena.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARENA_DEFINED
+#define ARENA_DEFINED
+
+#include <stddef.h>
+
+// the alignment of every allocation (enough for any pointer, int or float)
+#define ARENA_ALIGN 8
+
+// A block of the arena: its memory follows the header
+typedef struct arena_block_t {
+  struct arena_block_t *next; // the block filled before this one
+  size_t size; // the bytes available after the header
+} ArenaBlock;
+
+// Objects are carved out of the current block by bumping a pointer: there
+// is no per-object header and no per-object free, the whole arena is
+// released with arena_free in one pass over its (few) blocks
+typedef struct arena_t {
+  size_t block_size; // the size of a new block (larger objects get their own)
+  char *next; // the first free byte in the current block
+  char *end; // the end of the current block
+  ArenaBlock *blocks; // the current block, linked to the previous ones
+  size_t allocated; // the bytes handed out so far
+} Arena;
+
+Arena* arena_new(size_t block_size);
+// allocates a new block with room for at least size bytes: used by arena_alloc
+void* arena_alloc_block(Arena *a, size_t size);
+void arena_free(Arena *a);
+
+// allocates size bytes (aligned to ARENA_ALIGN): they're released by arena_free
+static inline void* arena_alloc(Arena *a, size_t size) {
+  size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+  if((size_t)(a->end - a->next) < size) {
+    return arena_alloc_block(a, size);
+  }
+  void *p = a->next;
+  a->next += size;
+  a->allocated += size;
+  return p;
+}
+
+#endif
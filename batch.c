@@ -0,0 +1,109 @@
+// Many SPT queries on the same graph, run in parallel by a team of threads
+/*
+ * batch.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "batch.h"
+// the algorithms
+#include "spt.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+
+// The state shared by the threads of a batch
+typedef struct spt_batch_t {
+  const CsrGraph *G;
+  GPtrArray *queries;
+  SptAlgorithm algorithm;
+  float max_path;
+  gint next_query; // the first query not taken by any thread yet
+  float *labels;
+  int *predecessors;
+  int *iterations;
+  SptResultFunc result;
+  gpointer data;
+} SptBatch;
+
+// The body of each thread: takes the next query until there are none left
+static gpointer batch_worker(gpointer arg) {
+  SptBatch *b = arg;
+  SptWorkspace *ws = spt_workspace_new(b->G->order);
+  float *labels;
+  int *preds;
+  int q, it;
+  GArray *roots;
+  while((q = g_atomic_int_add(&b->next_query, 1)) < (gint)b->queries->len) {
+    roots = g_ptr_array_index(b->queries, q);
+    // the results are written directly in the caller's buffers, if any
+    labels = (b->labels ? b->labels + (size_t)q * b->G->order : ws->labels);
+    preds = (b->predecessors ? b->predecessors + (size_t)q * b->G->order : ws->predecessors);
+    if(b->algorithm) {
+      it = b->algorithm(b->G, roots, b->max_path, labels, preds);
+    }
+    else {
+      it = spt_s_heap(b->G, roots, b->max_path, labels, preds, ws->Q, NULL);
+    }
+    if(b->iterations) {
+      b->iterations[q] = it;
+    }
+    if(b->result) {
+      b->result(q, roots, labels, preds, it, b->data);
+    }
+  }
+  spt_workspace_free(ws);
+  return NULL;
+}
+
+void spt_batch(
+  const CsrGraph *G,
+  GPtrArray *queries,
+  SptAlgorithm algorithm,
+  int n_threads,
+  float *labels,
+  int *predecessors,
+  int *iterations,
+  SptResultFunc result,
+  gpointer data
+) {
+  // the same bound on the paths used by the spt program
+  SptBatch b = {G, queries, algorithm, (float)G->order * G->max_weight + 1.0, 0,
+                labels, predecessors, iterations, result, data};
+  if(n_threads < 1) {
+    n_threads = 1;
+  }
+  if(n_threads > (int)queries->len) {
+    n_threads = MAX(1, (int)queries->len);
+  }
+  // the calling thread is one of the team
+  GThread **team = (GThread **)malloc(n_threads * sizeof(GThread *));
+  if(!team) {
+    g_error("Failed to alloc the threads");
+  }
+  int i;
+  for(i = 1; i < n_threads; i++) {
+    team[i] = g_thread_new("spt-batch", batch_worker, &b);
+  }
+  batch_worker(&b);
+  for(i = 1; i < n_threads; i++) {
+    g_thread_join(team[i]);
+  }
+  free(team);
+}
@@ -0,0 +1,60 @@
+// Many SPT queries on the same graph, run in parallel by a team of threads (header file)
+/*
+ * batch.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_DEFINED
+#define BATCH_DEFINED
+
+#include "glib-graph.h"
+// the scratch space of the threads (see SptWorkspace)
+#include "spt.h"
+
+#include <glib.h>
+
+// The signature of the algorithms in spt.h
+typedef int (*SptAlgorithm)(const CsrGraph *, GArray *, float, float *, int *);
+
+// Called by the worker threads with the result of the query-th root set:
+// the arrays are only valid during the call, and the calls for different
+// queries can happen concurrently (and in any order)
+typedef void (*SptResultFunc)(int query, GArray *roots, const float *labels,
+                              const int *predecessors, int iterations, gpointer data);
+
+// Finds the SPT of G for each root set in queries (a GPtrArray of GArray* of
+// int), using n_threads threads (at least 1) that take the queries in order
+// algorithm is any of the algorithms in spt.h, or NULL for Dijkstra with the
+// heap of the workspace (spt_s_heap)
+// The results go to the buffers that are not NULL: labels and predecessors
+// hold queries->len * G->order elements (query q from q * G->order on),
+// iterations queries->len; then result (if not NULL) is called with them
+// G is only read, so the threads share it
+void spt_batch(
+  const CsrGraph *G,
+  GPtrArray *queries,
+  SptAlgorithm algorithm,
+  int n_threads,
+  float *labels,
+  int *predecessors,
+  int *iterations,
+  SptResultFunc result,
+  gpointer data
+);
+
+#endif
@@ -0,0 +1,145 @@
+// Benchmark of many SPT queries on the same graph: the spt program run once per
+// query (reading the graph each time), the batch mode of spt (-b) and spt_batch
+// with an increasing number of threads
+// Usage: bench/bench-batch [order] [queries]
+// A random graph with order vertices (default 200000) is generated and saved
+// in the binary format, then queries roots (default 64) are solved by Dijkstra
+// Must be run from the directory containing the spt program
+/*
+ * bench-batch.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glib-graph.h"
+#include "bench-graph.h"
+#include "batch.h"
+
+#include <glib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// the average degree of the generated graph
+#define GEN_DEGREE 8
+
+// runs a shell command and returns the time it took (in seconds)
+static double time_command(const char *cmd) {
+  GTimer *timer = g_timer_new();
+  if(system(cmd) != 0) {
+    g_error("\"%s\" failed", cmd);
+  }
+  double t = g_timer_elapsed(timer, NULL);
+  g_timer_destroy(timer);
+  return t;
+}
+
+int main(int argc, char **argv) {
+  int order = (argc > 1 ? atoi(argv[1]) : 200000);
+  int n_queries = (argc > 2 ? atoi(argv[2]) : 64);
+  int i, q, threads;
+
+  char *dir = g_path_get_dirname(argv[0]);
+  char *options = g_strdup_printf("-t random -n %d -d %d", order, GEN_DEGREE);
+  CsrGraph *G = bench_graph_generate(dir, options);
+  g_free(options);
+  g_free(dir);
+  srand(42);
+  char graph_path[] = "/tmp/spt-bench-graph-XXXXXX";
+  char batch_path[] = "/tmp/spt-bench-roots-XXXXXX";
+  close(mkstemp(graph_path));
+  csr_graph_save(G, graph_path);
+
+  // one root per query
+  GPtrArray *queries = g_ptr_array_new();
+  FILE *batch = fdopen(mkstemp(batch_path), "w");
+  for(q = 0; q < n_queries; q++) {
+    GArray *roots = g_array_new(FALSE, FALSE, sizeof(int));
+    int root = rand() % order;
+    g_array_append_val(roots, root);
+    g_ptr_array_add(queries, roots);
+    fprintf(batch, "%d\n", root);
+  }
+  fclose(batch);
+
+  printf("%d vertices, %d edges, %d queries (%d processors)\n",
+         G->order, G->size, n_queries, g_get_num_processors());
+  printf("%-28s %10s %12s %9s\n", "run", "time (s)", "queries/s", "speedup");
+
+  // the spt program, started once per query
+  GTimer *timer = g_timer_new();
+  for(q = 0; q < n_queries; q++) {
+    char *cmd = g_strdup_printf("./spt -f %s -r %d -a dijkstra -q heap -o cost >/dev/null 2>&1",
+                                graph_path, g_array_index((GArray *)g_ptr_array_index(queries, q), int, 0));
+    if(system(cmd) != 0) {
+      g_error("\"%s\" failed", cmd);
+    }
+    g_free(cmd);
+  }
+  double t_seq = g_timer_elapsed(timer, NULL);
+  printf("%-28s %10.3f %12.1f %8.2fx\n", "spt once per query", t_seq, n_queries / t_seq, 1.0);
+
+  // the spt program in batch mode: the graph is read once
+  char *cmd = g_strdup_printf("./spt -f %s -b %s -a dijkstra -q heap -o cost >/dev/null 2>&1",
+                              graph_path, batch_path);
+  double t = time_command(cmd);
+  g_free(cmd);
+  printf("%-28s %10.3f %12.1f %8.2fx\n", "spt -b", t, n_queries / t, t_seq / t);
+
+  // spt_batch in this process, keeping all the results to check them
+  float *labels = (float *)malloc((size_t)n_queries * order * sizeof(float));
+  float *reference = (float *)malloc((size_t)n_queries * order * sizeof(float));
+  int *preds = (int *)malloc((size_t)n_queries * order * sizeof(int));
+  if(!labels || !reference || !preds) {
+    g_error("Failed to alloc the results");
+  }
+  char name[32];
+  double t_one = 0.0;
+  int max_threads = MAX(4, g_get_num_processors());
+  for(threads = 1; threads <= max_threads; threads *= 2) {
+    g_timer_start(timer);
+    spt_batch(G, queries, NULL, threads, (threads == 1 ? reference : labels), preds, NULL, NULL, NULL);
+    t = g_timer_elapsed(timer, NULL);
+    if(threads == 1) {
+      t_one = t;
+    }
+    // every thread count must find the same labels
+    gboolean same = TRUE;
+    for(i = 0; threads > 1 && i < n_queries * order; i++) {
+      if(labels[i] != reference[i]) {
+        same = FALSE;
+      }
+    }
+    snprintf(name, sizeof(name), "spt_batch, %d thread%s", threads, threads > 1 ? "s" : "");
+    printf("%-28s %10.3f %12.1f %8.2fx  (%.2fx over 1 thread) %s\n", name, t, n_queries / t, t_seq / t,
+           t_one / t, same ? "" : "MISMATCH");
+  }
+
+  g_timer_destroy(timer);
+  unlink(graph_path);
+  unlink(batch_path);
+  for(q = 0; q < n_queries; q++) {
+    g_array_free(g_ptr_array_index(queries, q), TRUE);
+  }
+  g_ptr_array_free(queries, TRUE);
+  free(labels);
+  free(reference);
+  free(preds);
+  csr_graph_free(G);
+  return 0;
+}
@@ -0,0 +1,45 @@
+// The graphs of the benchmarks, made by bench/gen-graph
+/*
+ * bench-graph.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench-graph.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+CsrGraph* bench_graph_generate(const char *dir, const char *options) {
+  char path[] = "/tmp/spt-bench-graph-XXXXXX";
+  int fd = mkstemp(path);
+  if(fd == -1) {
+    g_error("Can't create a temporary file for the graph");
+  }
+  close(fd);
+  char *cmd = g_strdup_printf("%s/gen-graph %s > %s", dir, options, path);
+  if(system(cmd) != 0) {
+    g_error("\"%s\" failed", cmd);
+  }
+  g_free(cmd);
+  size_t bytes;
+  CsrGraph *G = csr_graph_load(path, &bytes, NULL);
+  unlink(path);
+  return G;
+}
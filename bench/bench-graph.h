@@ -0,0 +1,33 @@
+// The graphs of the benchmarks, made by bench/gen-graph (header file)
+/*
+ * bench-graph.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_GRAPH_DEFINED
+#define BENCH_GRAPH_DEFINED
+
+#include "glib-graph.h"
+
+/*  Generates a graph with gen-graph, which must be in dir (the directory of the
+    benchmark, see g_path_get_dirname), called with the given options, e.g.
+    "-t random -n 100000 -d 8": the graph goes through a temporary file
+*/
+CsrGraph* bench_graph_generate(const char *dir, const char *options);
+
+#endif
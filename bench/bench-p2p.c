@@ -0,0 +1,130 @@
+// Benchmark of the point-to-point queries: the same random queries are answered
+// by Dijkstra stopped at the target, bidirectional Dijkstra, ALT and contraction
+// hierarchies, printing the
+// average number of vertices settled and the time per query of each
+// Usage: bench/bench-p2p [graph] [queries] [landmarks]
+// The graph is read from the file (text or binary format), or a grid of
+// 300 x 300 vertices with random weights is generated if it's missing or "-"
+/*
+ * bench-p2p.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glib-graph.h"
+#include "bench-graph.h"
+#include "p2p.h"
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the side of the generated grid
+#define GRID_SIDE 300
+
+int main(int argc, char **argv) {
+  int n_queries = (argc > 2 ? atoi(argv[2]) : 1000);
+  int k = (argc > 3 ? atoi(argv[3]) : 16);
+  int q, m;
+  size_t bytes;
+
+  CsrGraph *G;
+  if(argc > 1 && strcmp(argv[1], "-") != 0) {
+    G = csr_graph_load(argv[1], &bytes, NULL);
+  }
+  else {
+    char *dir = g_path_get_dirname(argv[0]);
+    char *options = g_strdup_printf("-t grid -n %d", GRID_SIDE * GRID_SIDE);
+    G = bench_graph_generate(dir, options);
+    g_free(options);
+    g_free(dir);
+  }
+  srand(42);
+  CsrGraph *R = csr_graph_reverse(G);
+  P2pWorkspace *ws = p2p_workspace_new(G->order);
+  GArray *path = g_array_new(FALSE, FALSE, sizeof(int));
+  int *ends = (int *)malloc(2 * n_queries * sizeof(int));
+  float *reference = (float *)malloc(n_queries * sizeof(float));
+  if(!ends || !reference) {
+    g_error("Failed to alloc the queries");
+  }
+  for(q = 0; q < 2 * n_queries; q++) {
+    ends[q] = rand() % G->order;
+  }
+
+  GTimer *timer = g_timer_new();
+  Landmarks *lm = landmarks_new(G, R, k);
+  printf("%d vertices, %d edges, %d queries, %d landmarks (chosen in %.3f s)\n",
+         G->order, G->size, n_queries, lm->k, g_timer_elapsed(timer, NULL));
+  g_timer_start(timer);
+  ChGraph *H = ch_graph_new(G);
+  printf("contraction hierarchy: %d shortcuts (contracted in %.3f s)\n", H->shortcuts, g_timer_elapsed(timer, NULL));
+  printf("%-12s %10s %16s %16s %9s\n", "method", "time (s)", "us per query", "settled/query", "settled");
+
+  const char *names[4] = {"dijkstra", "bidijkstra", "alt", "ch"};
+  double t, times[4], t_dijkstra = 0.0;
+  long total, total_dijkstra = 0;
+  int settled;
+  float cost;
+  for(m = 0; m < 4; m++) {
+    gboolean same = TRUE;
+    total = 0;
+    g_timer_start(timer);
+    for(q = 0; q < n_queries; q++) {
+      if(m == 1) {
+        cost = p2p_bidijkstra(G, R, ws, ends[2 * q], ends[2 * q + 1], path, &settled);
+      }
+      else if(m == 3) {
+        cost = p2p_ch(H, ws, ends[2 * q], ends[2 * q + 1], path, &settled);
+      }
+      else {
+        cost = p2p_alt(G, (m == 2 ? lm : NULL), ws, ends[2 * q], ends[2 * q + 1], path, &settled);
+      }
+      total += settled;
+      // every method must find the same costs (up to the rounding of the sums)
+      if(m == 0) {
+        reference[q] = cost;
+      }
+      else if(cost != reference[q] && !(fabsf(cost - reference[q]) <= 1e-4 * reference[q])) {
+        same = FALSE;
+      }
+    }
+    t = g_timer_elapsed(timer, NULL);
+    times[m] = t;
+    if(m == 0) {
+      t_dijkstra = t;
+      total_dijkstra = total;
+    }
+    printf("%-12s %10.3f %16.1f %16.1f %8.1f%% %s\n", names[m], t, t * 1e6 / n_queries,
+           (double)total / n_queries, 100.0 * total / MAX(total_dijkstra, 1), same ? "" : "MISMATCH");
+  }
+  printf("alt is %.2fx faster than dijkstra, ch %.2fx\n", t_dijkstra / times[2], t_dijkstra / times[3]);
+
+  g_timer_destroy(timer);
+  free(ends);
+  free(reference);
+  g_array_free(path, TRUE);
+  landmarks_free(lm);
+  ch_graph_free(H);
+  p2p_workspace_free(ws);
+  csr_graph_free(R);
+  csr_graph_free(G);
+  return 0;
+}
@@ -0,0 +1,119 @@
+// Benchmark and stress check of the parallel Bellman-Ford: spt_lp on a graph
+// with negative weights from gen-graph, on teams with more and more threads,
+// each run checked against spt_l from the same roots
+/*
+ * bench-parallel.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glib-graph.h"
+#include "spt.h"
+#include "team.h"
+#include "bench-graph.h"
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// the average degree of the generated graph
+#define GEN_DEGREE 8
+// the roots of each team, each solved by spt_l and by spt_lp
+#define N_ROOTS 8
+// the largest team
+#define MAX_THREADS 8
+
+// TRUE if the labels are the same: the sums along paths of the same cost may
+// be rounded differently, so they may differ by the rounding of the floats
+static gboolean same_labels(const float *a, const float *b, int n) {
+  int i;
+  for(i = 0; i < n; i++) {
+    if(fabsf(a[i] - b[i]) > 1e-5 * MAX(fabsf(a[i]), 1.0)) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+int main(int argc, char **argv) {
+  int order = (argc > 1 ? atoi(argv[1]) : 100000);
+  int threads, r;
+
+  char *dir = g_path_get_dirname(argv[0]);
+  char *options = g_strdup_printf("-t negative -n %d -d %d", order, GEN_DEGREE);
+  CsrGraph *G = bench_graph_generate(dir, options);
+  g_free(options);
+  g_free(dir);
+  srand(42);
+
+  float max_path = (float)G->order * MAX(G->max_weight, 1.0) + 1.0;
+  float *labels = (float *)malloc(G->order * sizeof(float));
+  float *reference = (float *)malloc(N_ROOTS * G->order * sizeof(float));
+  int *preds = (int *)malloc(G->order * sizeof(int));
+  if(!labels || !reference || !preds) {
+    g_error("Failed to alloc the SPT");
+  }
+  int roots_v[N_ROOTS];
+  GArray *roots = g_array_new(FALSE, FALSE, sizeof(int));
+
+  printf("%d vertices, %d edges, weights in [%.3f, %.3f] (%d processors)\n",
+         G->order, G->size, G->min_weight, G->max_weight, g_get_num_processors());
+  printf("%-22s %10s %9s\n", "run", "time (s)", "speedup");
+
+  // the reference labels, found by spt_l
+  GTimer *timer = g_timer_new();
+  for(r = 0; r < N_ROOTS; r++) {
+    roots_v[r] = rand() % G->order;
+    g_array_set_size(roots, 0);
+    g_array_append_val(roots, roots_v[r]);
+    if(spt_l(G, roots, max_path, reference + (size_t)r * G->order, preds) == NO_LOWER_BOUND) {
+      g_error("gen-graph wrote a negative cycle");
+    }
+  }
+  double t_seq = g_timer_elapsed(timer, NULL);
+  printf("%-22s %10.3f %8.2fx\n", "spt_l", t_seq, 1.0);
+
+  // every team must find the same labels from every root
+  char name[32];
+  for(threads = 1; threads <= MAX_THREADS; threads *= 2) {
+    Team *team = team_new(threads);
+    gboolean same = TRUE;
+    g_timer_start(timer);
+    for(r = 0; r < N_ROOTS; r++) {
+      g_array_set_size(roots, 0);
+      g_array_append_val(roots, roots_v[r]);
+      if(spt_lp_team(G, roots, max_path, labels, preds, team, NULL) == NO_LOWER_BOUND
+         || !same_labels(labels, reference + (size_t)r * G->order, G->order)) {
+        same = FALSE;
+      }
+    }
+    double t = g_timer_elapsed(timer, NULL);
+    team_free(team);
+    snprintf(name, sizeof(name), "spt_lp, %d thread%s", threads, threads > 1 ? "s" : "");
+    printf("%-22s %10.3f %8.2fx  %s\n", name, t, t_seq / t, same ? "same labels" : "MISMATCH");
+  }
+
+  g_timer_destroy(timer);
+  g_array_free(roots, TRUE);
+  free(labels);
+  free(reference);
+  free(preds);
+  csr_graph_free(G);
+  return 0;
+}
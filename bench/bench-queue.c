@@ -0,0 +1,206 @@
+// Benchmark of the priority queue used by Dijkstra's algorithm: the sorted GQueue
+// that spt_s used to keep (O(|Q|) insertion and membership check) against the
+// indexed d-ary heap in heap.c (O(log |Q|) insertion and decrease-key)
+// Usage: bench/bench-queue [graph files...]
+// Without arguments the graphs in tests/g100_wdS.txt and tests/g100_wdL.txt are used
+// Then random graphs of increasing size are generated and solved as well
+
+/*
+ * bench-queue.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glib-graph.h"
+#include "bench-graph.h"
+#include "heap.h"
+
+#include <glib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// the number of edges relaxed in each measurement (the runs are repeated
+// on small graphs, so that the time measured is meaningful)
+#define EDGES_PER_RUN 2000000
+// the average degree of the generated graphs
+#define GEN_DEGREE 8
+
+// GCompareDataFunc ordering vertices by their label (user_data)
+static gint smallest_label(gconstpointer a, gconstpointer b, gpointer user_data) {
+  float *labels = user_data;
+  float la = labels[GPOINTER_TO_INT(a)];
+  float lb = labels[GPOINTER_TO_INT(b)];
+  if(la < lb) {
+    return -1;
+  }
+  if(la > lb) {
+    return 1;
+  }
+  return 0;
+}
+
+// Dijkstra with Q kept as a sorted GQueue, as spt_s used to do:
+// a vertex already in Q keeps its position even if its label decreases
+static int dijkstra_gqueue(const CsrGraph *G, int root, float *labels, int *pred) {
+  GQueue *Q = g_queue_new();
+  int i, k, u, v, count_it = 0;
+  for(i = 0; i < G->order; i++) {
+    labels[i] = INFINITY;
+    pred[i] = root;
+  }
+  labels[root] = 0.0;
+  g_queue_push_head(Q, GINT_TO_POINTER(root));
+  while(!g_queue_is_empty(Q)) {
+    count_it++;
+    u = GPOINTER_TO_INT(g_queue_pop_head(Q));
+    for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+      v = G->dest[k];
+      if(labels[u] + G->weight[k] < labels[v]) {
+        labels[v] = labels[u] + G->weight[k];
+        pred[v] = u;
+        if(g_queue_find(Q, GINT_TO_POINTER(v)) == NULL) {
+          g_queue_insert_sorted(Q, GINT_TO_POINTER(v), smallest_label, labels);
+        }
+      }
+    }
+  }
+  g_queue_free(Q);
+  return count_it;
+}
+
+// Dijkstra with Q as an indexed d-ary heap, as spt_s does now
+static int dijkstra_heap(const CsrGraph *G, int root, float *labels, int *pred) {
+  Heap *Q = heap_new(G->order);
+  int i, k, u, v, count_it = 0;
+  for(i = 0; i < G->order; i++) {
+    labels[i] = INFINITY;
+    pred[i] = root;
+  }
+  labels[root] = 0.0;
+  heap_push(Q, root, 0.0);
+  while(!heap_is_empty(Q)) {
+    count_it++;
+    u = heap_pop(Q, NULL);
+    for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+      v = G->dest[k];
+      if(labels[u] + G->weight[k] < labels[v]) {
+        labels[v] = labels[u] + G->weight[k];
+        pred[v] = u;
+        heap_push_or_decrease(Q, v, labels[v]);
+      }
+    }
+  }
+  heap_free(Q);
+  return count_it;
+}
+
+// reads a graph in the format of the tests directory with new_graph
+static CsrGraph* load_graph(const char *path) {
+  FILE *input = fopen(path, "r");
+  if(!input) {
+    g_error("Can't open %s", path);
+  }
+  float min_w, max_w;
+  Graph *g = new_graph(input, &min_w, &max_w);
+  CsrGraph *csr = csr_graph_from_graph(g);
+  graph_free(g);
+  fclose(input);
+  return csr;
+}
+
+// times both queues on G and prints a line of the report
+static void bench_graph(const char *name, const CsrGraph *G, gboolean run_gqueue) {
+  float *lq = (float *)malloc(G->order * sizeof(float));
+  float *lh = (float *)malloc(G->order * sizeof(float));
+  int *pred = (int *)malloc(G->order * sizeof(int));
+  int reps = MAX(1, EDGES_PER_RUN / MAX(G->size, 1));
+  int r, it_q = 0, it_h = 0, i;
+  double t_q = 0.0, t_h;
+  GTimer *timer = g_timer_new();
+
+  if(run_gqueue) {
+    g_timer_start(timer);
+    for(r = 0; r < reps; r++) {
+      it_q = dijkstra_gqueue(G, 0, lq, pred);
+    }
+    t_q = g_timer_elapsed(timer, NULL) * 1000.0 / reps;
+  }
+  g_timer_start(timer);
+  for(r = 0; r < reps; r++) {
+    it_h = dijkstra_heap(G, 0, lh, pred);
+  }
+  t_h = g_timer_elapsed(timer, NULL) * 1000.0 / reps;
+
+  // both must find the same labels
+  gboolean same = TRUE;
+  for(i = 0; run_gqueue && i < G->order; i++) {
+    if(lq[i] != lh[i]) {
+      same = FALSE;
+    }
+  }
+  if(run_gqueue) {
+    printf("%-16s %9d %10d %12.3f %12.3f %9.1fx %8d %8d %s\n",
+           name, G->order, G->size, t_q, t_h, t_q / t_h, it_q, it_h, same ? "ok" : "MISMATCH");
+  }
+  else {
+    printf("%-16s %9d %10d %12s %12.3f %10s %8s %8d %s\n",
+           name, G->order, G->size, "-", t_h, "-", "-", it_h, "-");
+  }
+
+  g_timer_destroy(timer);
+  free(lq);
+  free(lh);
+  free(pred);
+}
+
+int main(int argc, char **argv) {
+  char *defaults[] = {"tests/g100_wdS.txt", "tests/g100_wdL.txt"};
+  char **files = argc > 1 ? argv + 1 : defaults;
+  int n_files = argc > 1 ? argc - 1 : 2;
+  int i;
+  char name[32];
+  char *basename;
+  CsrGraph *G;
+
+  printf("HEAP_ARITY = %d\n", HEAP_ARITY);
+  printf("%-16s %9s %10s %12s %12s %10s %8s %8s %s\n",
+         "graph", "|V|", "|E|", "gqueue (ms)", "heap (ms)", "speedup", "it gq", "it heap", "labels");
+  for(i = 0; i < n_files; i++) {
+    G = load_graph(files[i]);
+    basename = g_path_get_basename(files[i]);
+    bench_graph(basename, G, TRUE);
+    g_free(basename);
+    csr_graph_free(G);
+  }
+
+  char *dir = g_path_get_dirname(argv[0]);
+  char *options;
+  int sizes[] = {1000, 10000, 100000, 1000000};
+  for(i = 0; i < 4; i++) {
+    options = g_strdup_printf("-t random -n %d -d %d", sizes[i], GEN_DEGREE);
+    G = bench_graph_generate(dir, options);
+    g_free(options);
+    snprintf(name, sizeof(name), "random-%d", sizes[i]);
+    // the sorted GQueue is quadratic: skip it on the largest graph
+    bench_graph(name, G, sizes[i] <= 10000);
+    csr_graph_free(G);
+  }
+  g_free(dir);
+  return 0;
+}
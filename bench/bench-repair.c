@@ -0,0 +1,173 @@
+// Benchmark of spt_repair: batches of random changes to the weights of a random
+// graph (heavier, lighter and removed edges) are applied, and the SPT is
+// repaired, then checked against Dijkstra's algorithm run from scratch
+// The last batches insert new edges too, which costs a pass over the graph,
+// and the last rounds keep raising the maximum weight (and so max_path)
+// Usage: bench/bench-repair [order] [rounds]
+/*
+ * bench-repair.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glib-graph.h"
+#include "bench-graph.h"
+#include "spt.h"
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// the average degree of the generated graph
+#define GEN_DEGREE 8
+
+// a random change: one of the edges of a random vertex gets a random weight
+// in [1, max_weight) or is removed (one time in four), or if insert a new
+// edge may be inserted
+static SptChange random_change(const CsrGraph *G, gboolean insert, float max_weight) {
+  SptChange c;
+  c.from = rand() % G->order;
+  int degree = G->offsets[c.from + 1] - G->offsets[c.from];
+  c.to = (degree > 0 && !insert ? G->dest[G->offsets[c.from] + rand() % degree] : rand() % G->order);
+  c.weight = (rand() % 4 == 0 && !insert ? INFINITY : 1.0 + (max_weight - 1.0) * ((float)rand() / RAND_MAX));
+  return c;
+}
+
+// the same labels, up to the rounding of the floats
+static gboolean same_labels(const float *labels, const float *reference, int order) {
+  int i;
+  for(i = 0; i < order; i++) {
+    if(fabsf(labels[i] - reference[i]) > 1e-3 * MAX(1.0, reference[i])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+// the path 0 -> 1 -> 2 with weights 1, whose first edge gets heavier and
+// heavier: the labels soon go beyond the first max_path (4)
+static gboolean check_chain(void) {
+  CsrEdge edges[2] = {{0, 1, 1.0}, {1, 2, 1.0}};
+  CsrGraph *G = csr_graph_from_edges(3, edges, 2);
+  CsrGraph *R = csr_graph_reverse(G);
+  GArray *roots = g_array_new(FALSE, FALSE, sizeof(int));
+  int root = 0;
+  g_array_append_val(roots, root);
+  float max_path = 3 * G->max_weight + 1.0;
+  float labels[3], reference[3];
+  int preds[3], ref_preds[3];
+  Heap *Q = heap_new(3);
+  spt_s_heap(G, roots, max_path, labels, preds, Q, NULL);
+  gboolean same = TRUE;
+  SptChange c = {0, 1, 1.0};
+  int r;
+  for(r = 0; r < 4; r++) {
+    c.weight *= 100.0;
+    spt_repair(G, R, roots, &max_path, labels, preds, &c, 1, Q);
+    spt_s_heap(G, roots, max_path, reference, ref_preds, Q, NULL);
+    same = same && same_labels(labels, reference, 3) && preds[2] == 1;
+  }
+  heap_free(Q);
+  g_array_free(roots, TRUE);
+  csr_graph_free(R);
+  csr_graph_free(G);
+  return same;
+}
+
+int main(int argc, char **argv) {
+  int order = (argc > 1 ? atoi(argv[1]) : 200000);
+  int rounds = (argc > 2 ? atoi(argv[2]) : 5);
+  int insert, batch, r, i, it;
+
+  char *dir = g_path_get_dirname(argv[0]);
+  char *options = g_strdup_printf("-t random -n %d -d %d", order, GEN_DEGREE);
+  CsrGraph *G = bench_graph_generate(dir, options);
+  g_free(options);
+  g_free(dir);
+  srand(42);
+  CsrGraph *R = csr_graph_reverse(G);
+  GArray *roots = g_array_new(FALSE, FALSE, sizeof(int));
+  int root = 0;
+  g_array_append_val(roots, root);
+  float max_path = (float)order * G->max_weight + 1.0;
+  float *labels = (float *)malloc(order * sizeof(float));
+  float *reference = (float *)malloc(order * sizeof(float));
+  int *preds = (int *)malloc(order * sizeof(int));
+  int *ref_preds = (int *)malloc(order * sizeof(int));
+  Heap *Q = heap_new(order);
+  SptChange *changes = (SptChange *)malloc(10000 * sizeof(SptChange));
+  if(!labels || !reference || !preds || !ref_preds || !changes) {
+    g_error("Failed to alloc the arrays");
+  }
+
+  GTimer *timer = g_timer_new();
+  spt_s_heap(G, roots, max_path, labels, preds, Q, NULL);
+  double t_full = g_timer_elapsed(timer, NULL);
+  printf("%d vertices, %d edges: Dijkstra from scratch in %.3f ms\n", G->order, G->size, t_full * 1e3);
+  printf("%8s %9s %14s %14s %10s\n", "changes", "inserted", "repair (ms)", "iterations", "speedup");
+
+  for(insert = 0; insert < 2; insert++) {
+    for(batch = 1; batch <= 10000; batch *= 10) {
+      double t_repair = 0.0;
+      long total_it = 0;
+      gboolean same = TRUE;
+      for(r = 0; r < rounds; r++) {
+        for(i = 0; i < batch; i++) {
+          changes[i] = random_change(G, insert && i % 4 == 0, 100.0);
+        }
+        g_timer_start(timer);
+        it = spt_repair(G, R, roots, &max_path, labels, preds, changes, batch, Q);
+        t_repair += g_timer_elapsed(timer, NULL);
+        total_it += it;
+        // the repaired labels must be the same as the ones found from scratch
+        spt_s_heap(G, roots, max_path, reference, ref_preds, Q, NULL);
+        same = same && same_labels(labels, reference, order);
+      }
+      printf("%8d %9d %14.3f %14.1f %9.1fx %s\n", batch, insert ? (batch + 3) / 4 : 0,
+             t_repair * 1e3 / rounds, (double)total_it / rounds,
+             t_full * rounds / t_repair, same ? "" : "MISMATCH");
+    }
+  }
+
+  // repeated increases of the maximum weight, which move max_path each time
+  gboolean same = check_chain();
+  float max_weight = 100.0;
+  for(r = 0; r < rounds; r++) {
+    max_weight *= 10.0;
+    for(i = 0; i < 100; i++) {
+      changes[i] = random_change(G, FALSE, max_weight);
+    }
+    spt_repair(G, R, roots, &max_path, labels, preds, changes, 100, Q);
+    spt_s_heap(G, roots, max_path, reference, ref_preds, Q, NULL);
+    same = same && same_labels(labels, reference, order);
+  }
+  printf("raising the maximum weight up to %g: %s\n", max_weight, same ? "same labels" : "MISMATCH");
+
+  g_timer_destroy(timer);
+  heap_free(Q);
+  free(changes);
+  free(labels);
+  free(reference);
+  free(preds);
+  free(ref_preds);
+  g_array_free(roots, TRUE);
+  csr_graph_free(R);
+  csr_graph_free(G);
+  return 0;
+}
@@ -0,0 +1,184 @@
+// Microbenchmark of the memory layout of Dijkstra's algorithm: spt_s, which works
+// on the caller's labels and predecessors arrays, against the previous version,
+// which allocated one element (vertex, predecessor, label) per vertex, reached
+// through an array of pointers, and copied them in the arrays at the end
+// The time, the allocations and the minor page faults (the memory touched for
+// the first time) of each are printed: for the cache misses run it under
+// perf stat -e cache-misses, once per version (the second argument)
+// Usage: bench/bench-spt-s [graph files...]
+// Without arguments the tests/g100 graphs and a generated graph with a million
+// vertices are used
+/*
+ * bench-spt-s.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glib-graph.h"
+#include "bench-graph.h"
+#include "spt.h"
+#include "heap.h"
+
+#include <glib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+// the average degree of the generated graph
+#define GEN_DEGREE 4
+#define GEN_ORDER 1000000
+
+// A vertex of the previous version of spt_s
+struct q_element {
+  int vertex;
+  int predecessor;
+  float label;
+};
+typedef struct q_element *Element;
+
+// the previous version of spt_s: order + 1 allocations, and every relaxation
+// goes through a pointer to a separately allocated element
+static int spt_s_elements(const CsrGraph *G, GArray *roots, float max_path, float *labels, int *predecessors) {
+  int root = g_array_index(roots, int, 0);
+  Heap *Q = heap_new(G->order);
+  Element *vertices = (Element *)malloc(G->order * sizeof(Element));
+  int i, k, dest, count_it = 0;
+  for(i = 0; i < G->order; i++) {
+    vertices[i] = (struct q_element *)malloc(sizeof(struct q_element));
+    vertices[i]->label = max_path;
+    vertices[i]->vertex = i;
+    vertices[i]->predecessor = root;
+  }
+  for(i = 0; i < roots->len; i++) {
+    root = g_array_index(roots, int, i);
+    if(vertices[root]->label != 0.0 || vertices[root]->predecessor != root) {
+      vertices[root]->label = 0.0;
+      vertices[root]->predecessor = root;
+      heap_push(Q, root, 0.0);
+    }
+  }
+  Element u;
+  while(!heap_is_empty(Q)) {
+    count_it++;
+    u = vertices[heap_pop(Q, NULL)];
+    for(k = G->offsets[u->vertex]; k < G->offsets[u->vertex + 1]; k++) {
+      dest = G->dest[k];
+      if(vertices[u->vertex]->label + G->weight[k] < vertices[dest]->label) {
+        vertices[dest]->label = vertices[u->vertex]->label + G->weight[k];
+        vertices[dest]->predecessor = u->vertex;
+        heap_push_or_decrease(Q, dest, vertices[dest]->label);
+      }
+    }
+  }
+  heap_free(Q);
+  for(i = 0; i < G->order; i++) {
+    labels[i] = vertices[i]->label;
+    predecessors[i] = vertices[i]->predecessor;
+    free(vertices[i]);
+  }
+  free(vertices);
+  return count_it;
+}
+
+// the minor page faults of this process so far
+static long minor_faults(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt;
+}
+
+// runs both versions on G (repeating them until they take a while) and prints
+// their time per run, allocations and page faults per run
+static void compare(const char *name, const CsrGraph *G, int which) {
+  GArray *roots = g_array_new(FALSE, FALSE, sizeof(int));
+  int root = 0;
+  g_array_append_val(roots, root);
+  float max_path = (float)(G->order) * G->max_weight + 1.0;
+  float *labels = (float *)malloc(G->order * sizeof(float));
+  int *preds = (int *)malloc(G->order * sizeof(int));
+  float *check = (float *)malloc(G->order * sizeof(float));
+  if(!labels || !preds || !check) {
+    g_error("Failed to alloc the arrays");
+  }
+  // the arrays are touched once, so their faults aren't counted
+  spt_s(G, roots, max_path, check, preds);
+  spt_s(G, roots, max_path, labels, preds);
+
+  const char *versions[2] = {"elements", "flat arrays"};
+  int runs, v, i;
+  for(v = 0; v < 2; v++) {
+    if(which != -1 && which != v) {
+      continue;
+    }
+    GTimer *timer = g_timer_new();
+    long faults = minor_faults();
+    for(runs = 0; runs == 0 || g_timer_elapsed(timer, NULL) < 0.5; runs++) {
+      if(v == 0) {
+        spt_s_elements(G, roots, max_path, labels, preds);
+      }
+      else {
+        spt_s(G, roots, max_path, labels, preds);
+      }
+    }
+    double t = g_timer_elapsed(timer, NULL) / runs;
+    faults = minor_faults() - faults;
+    g_timer_destroy(timer);
+    gboolean same = TRUE;
+    for(i = 0; i < G->order; i++) {
+      same = same && (labels[i] == check[i]);
+    }
+    printf("%-22s %-12s %12.3f %12d %14.1f %s\n", name, versions[v], t * 1e3,
+           (v == 0 ? G->order + 2 : 1), (double)faults / runs, same ? "" : "MISMATCH");
+  }
+  free(labels);
+  free(preds);
+  free(check);
+  g_array_free(roots, TRUE);
+}
+
+int main(int argc, char **argv) {
+  // the version to run alone (0 or 1) can be chosen with SPT_BENCH_VERSION,
+  // to measure the cache misses of each one under perf
+  const char *only = getenv("SPT_BENCH_VERSION");
+  int which = (only ? atoi(only) : -1);
+  size_t bytes;
+  int i;
+  printf("%-22s %-12s %12s %12s %14s\n", "graph", "version", "ms per run", "allocations", "page faults");
+  if(argc > 1) {
+    for(i = 1; i < argc; i++) {
+      CsrGraph *G = csr_graph_load(argv[i], &bytes, NULL);
+      compare(argv[i], G, which);
+      csr_graph_free(G);
+    }
+    return 0;
+  }
+  const char *tests[2] = {"tests/g100_wdL.txt", "tests/g100_wdS.txt"};
+  for(i = 0; i < 2; i++) {
+    CsrGraph *G = csr_graph_load(tests[i], &bytes, NULL);
+    compare(tests[i], G, which);
+    csr_graph_free(G);
+  }
+  char *dir = g_path_get_dirname(argv[0]);
+  char *options = g_strdup_printf("-t random -n %d -d %d", GEN_ORDER, GEN_DEGREE);
+  CsrGraph *G = bench_graph_generate(dir, options);
+  g_free(options);
+  g_free(dir);
+  compare("random, 1M vertices", G, which);
+  csr_graph_free(G);
+  return 0;
+}
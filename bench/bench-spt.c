@@ -0,0 +1,187 @@
+// Benchmark of spt_s and spt_l over a sweep of synthetic graphs made by gen-graph:
+// the time to parse the graph, to solve the SPT and to print it are measured
+// separately, with the edges relaxed per second, the iterations and the peak
+// memory of each run (run in its own process, so the peaks don't add up)
+// Usage: bench/bench-spt [max order]
+// The orders go from 1000 up to max order (default 100000) by factors of 10;
+// the dense graphs have a hundredth of the vertices (and at most 1000 edges
+// per vertex). The graphs with negative weights are only solved by spt_l
+// (with Tarjan's subtree disassembly if they have a negative cycle, which
+// FIFO Bellman-Ford only detects after |V| passes)
+// gen-graph must be in the same directory as this program
+/*
+ * bench-spt.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glib-graph.h"
+#include "spt.h"
+
+#include <glib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define DEFAULT_MAX_ORDER 100000
+#define MIN_ORDER 1000
+
+// the algorithms compared
+enum { RUN_SPT_S, RUN_SPT_L, RUN_SPT_L_TARJAN };
+static const char *run_names[] = {"spt_s", "spt_l", "spt_l (tarjan)"};
+
+// A graph of the sweep: its gen-graph type, the divisor of the order, the
+// maximum degree (0 for the default of gen-graph) and the algorithms run
+typedef struct bench_graph_t {
+  const char *type;
+  int order_divisor;
+  int max_degree;
+  int runs[2];
+  int n_runs;
+} BenchGraph;
+
+static const BenchGraph graphs[] = {
+  {"random", 1, 0, {RUN_SPT_S, RUN_SPT_L}, 2},
+  {"grid", 1, 0, {RUN_SPT_S, RUN_SPT_L}, 2},
+  {"dense", 100, 1000, {RUN_SPT_S, RUN_SPT_L}, 2},
+  {"negative", 1, 0, {RUN_SPT_L}, 1},
+  {"negcycle", 1, 0, {RUN_SPT_L_TARJAN}, 1},
+};
+
+// prints the SPT in the same format as the spt program
+static void print_spt(FILE *out, const char *algorithm, int root, const float *labels, const int *preds, int iterations, int order) {
+  double cost = 0.0;
+  int i;
+  fprintf(out, "After %d iterations, the SPT with root(s) [ %d ] found by %s is:\n", iterations, root, algorithm);
+  for(i = 0; i < order; i++) {
+    fprintf(out, "label[%d] = %.3f\tpred[%d] = %d\n", i, labels[i], i, preds[i]);
+    cost += labels[i];
+  }
+  fprintf(out, "Total cost of the SPT: %f\n", cost);
+}
+
+// parses the graph at path, solves the SPT from vertex 0 with the algorithm
+// run, prints it to /dev/null and prints a row of the results
+// It's run in a child process, so the peak RSS is its own
+static void bench_run(const char *type, const char *path, int run) {
+  size_t bytes;
+  GTimer *timer = g_timer_new();
+  CsrGraph *G = csr_graph_load(path, &bytes, NULL);
+  double t_parse = g_timer_elapsed(timer, NULL);
+
+  GArray *roots = g_array_new(FALSE, FALSE, sizeof(int));
+  int root = 0, iterations = 0;
+  g_array_append_val(roots, root);
+  float max_path = (float)G->order * MAX(G->max_weight, 1.0) + 1.0;
+  float *labels = (float *)malloc(G->order * sizeof(float));
+  int *preds = (int *)malloc(G->order * sizeof(int));
+  if(!labels || !preds) {
+    g_error("Failed to alloc the SPT");
+  }
+  g_timer_start(timer);
+  switch(run) {
+    case RUN_SPT_S:
+      iterations = spt_s(G, roots, max_path, labels, preds);
+      break;
+    case RUN_SPT_L:
+      iterations = spt_l(G, roots, max_path, labels, preds);
+      break;
+    case RUN_SPT_L_TARJAN:
+      iterations = spt_l_tarjan(G, roots, max_path, labels, preds, NULL, NULL);
+      break;
+  }
+  double t_solve = g_timer_elapsed(timer, NULL);
+
+  double t_output = 0.0;
+  if(iterations != NO_LOWER_BOUND) {
+    FILE *out = fopen("/dev/null", "w");
+    if(!out) {
+      g_error("Can't open /dev/null");
+    }
+    g_timer_start(timer);
+    print_spt(out, run_names[run], root, labels, preds, iterations, G->order);
+    fclose(out);
+    t_output = g_timer_elapsed(timer, NULL);
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  char iter_text[16];
+  if(iterations == NO_LOWER_BOUND) {
+    strcpy(iter_text, "neg. cycle");
+  }
+  else {
+    snprintf(iter_text, sizeof(iter_text), "%d", iterations);
+  }
+  printf("%-9s %9d %10d %-15s %9.3f %9.3f %9.3f %12.2f %11s %9.1f\n", type, G->order, G->size,
+         run_names[run], t_parse, t_solve, t_output, G->size / t_solve / 1e6, iter_text,
+         usage.ru_maxrss / 1024.0);
+
+  g_timer_destroy(timer);
+  g_array_free(roots, TRUE);
+  free(labels);
+  free(preds);
+  csr_graph_free(G);
+}
+
+int main(int argc, char **argv) {
+  int max_order = (argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_ORDER);
+  // gen-graph is next to this program
+  char *dir = g_path_get_dirname(argv[0]);
+  char path[] = "/tmp/spt-bench-graph-XXXXXX";
+  close(mkstemp(path));
+  int order, g, r, status;
+
+  printf("%-9s %9s %10s %-15s %9s %9s %9s %12s %11s %9s\n", "graph", "vertices", "edges", "algorithm",
+         "parse (s)", "solve (s)", "print (s)", "Medges/s", "iterations", "RSS (MB)");
+  for(order = MIN_ORDER; order <= max_order; order *= 10) {
+    for(g = 0; g < (int)G_N_ELEMENTS(graphs); g++) {
+      int n = MAX(order / graphs[g].order_divisor, 100);
+      char *degree = (graphs[g].max_degree > 0 && n / 2 > graphs[g].max_degree
+                      ? g_strdup_printf("-d %d", graphs[g].max_degree) : g_strdup(""));
+      char *cmd = g_strdup_printf("%s/gen-graph -t %s -n %d %s > %s", dir, graphs[g].type, n, degree, path);
+      g_free(degree);
+      if(system(cmd) != 0) {
+        g_error("\"%s\" failed", cmd);
+      }
+      g_free(cmd);
+      for(r = 0; r < graphs[g].n_runs; r++) {
+        fflush(stdout);
+        pid_t child = fork();
+        if(child == -1) {
+          g_error("Can't fork");
+        }
+        if(child == 0) {
+          bench_run(graphs[g].type, path, graphs[g].runs[r]);
+          fflush(stdout);
+          _exit(0);
+        }
+        if(waitpid(child, &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+          g_error("The run of %s on a %s graph failed", run_names[graphs[g].runs[r]], graphs[g].type);
+        }
+      }
+    }
+  }
+
+  unlink(path);
+  g_free(dir);
+  return 0;
+}
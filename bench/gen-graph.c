@@ -0,0 +1,185 @@
+// Generator of synthetic graphs in the text format read by spt, written to standard output
+// Usage: bench/gen-graph [-t type] [-n order] [-d degree] [-w weight] [-s seed] [-r root]
+// The types are
+//   random: each vertex has degree edges to random vertices
+//   grid: a road-like grid with about sqrt(order) vertices per side, each vertex
+//         linked both ways to its neighbours on the same row and column
+//   dense: each edge is present with probability degree / order (by default
+//          degree is order / 2)
+//   negative: a random graph with negative weights but no negative cycles
+//             (weights shifted by vertex potentials, which doesn't change cycle costs)
+//   negcycle: the same, with a negative cycle reachable from the root
+// The weights are uniform in [1, weight) (default 100), printed with 3 decimals
+// The root (default 0) is written on the line after the graph
+/*
+ * gen-graph.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// the graph types, in the order of their names
+enum { GEN_RANDOM, GEN_GRID, GEN_DENSE, GEN_NEGATIVE, GEN_NEGCYCLE, GEN_N_TYPES };
+static const char *type_names[GEN_N_TYPES] = {"random", "grid", "dense", "negative", "negcycle"};
+
+#define DEFAULT_ORDER 100000
+#define DEFAULT_DEGREE 4
+#define DEFAULT_WEIGHT 100.0
+// the size of the output buffer
+#define OUT_BUFFER_SIZE (1 << 20)
+
+static void usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-t random|grid|dense|negative|negcycle] [-n order] [-d degree] [-w weight] [-s seed] [-r root]\n", name);
+  exit(1);
+}
+
+// a weight uniformly distributed in [1, max_weight)
+static inline float random_weight(float max_weight) {
+  return 1.0 + (max_weight - 1.0) * ((float)rand() / ((float)RAND_MAX + 1.0));
+}
+
+static inline void print_edge(int dest, float weight) {
+  printf("%d:%.3f ", dest, weight);
+}
+
+int main(int argc, char **argv) {
+  int type = GEN_RANDOM, order = DEFAULT_ORDER, degree = -1, root = 0;
+  unsigned int seed = 42;
+  float max_weight = DEFAULT_WEIGHT;
+  int opt, i, j, u, v;
+  while((opt = getopt(argc, argv, "t:n:d:w:s:r:")) != -1) {
+    switch(opt) {
+      case 't':
+        for(type = 0; type < GEN_N_TYPES && strcmp(optarg, type_names[type]) != 0; type++);
+        if(type == GEN_N_TYPES) {
+          usage(argv[0]);
+        }
+        break;
+      case 'n':
+        order = atoi(optarg);
+        break;
+      case 'd':
+        degree = atoi(optarg);
+        break;
+      case 'w':
+        max_weight = atof(optarg);
+        break;
+      case 's':
+        seed = (unsigned int)strtoul(optarg, NULL, 10);
+        break;
+      case 'r':
+        root = atoi(optarg);
+        break;
+      default:
+        usage(argv[0]);
+    }
+  }
+  if(order < 4 || max_weight <= 1.0 || root < 0 || root >= order) {
+    usage(argv[0]);
+  }
+  if(degree < 0) {
+    degree = (type == GEN_DENSE ? order / 2 : DEFAULT_DEGREE);
+  }
+  srand(seed);
+  setvbuf(stdout, NULL, _IOFBF, OUT_BUFFER_SIZE);
+
+  // the vertex potentials of the negative graphs: the edge u -> v gets
+  // weight w + p[u] - p[v], so every cycle keeps its (positive) cost
+  float *potential = NULL;
+  if(type == GEN_NEGATIVE || type == GEN_NEGCYCLE) {
+    potential = (float *)malloc(order * sizeof(float));
+    if(!potential) {
+      g_error("Failed to alloc the potentials");
+    }
+    for(u = 0; u < order; u++) {
+      potential[u] = max_weight * ((float)rand() / ((float)RAND_MAX + 1.0));
+    }
+  }
+  // the negative cycle: root -> cycle[0] -> cycle[1] -> cycle[2] -> cycle[0],
+  // on three distinct vertices other than the root
+  int cycle[3];
+  for(i = 0; i < 3; i++) {
+    do {
+      cycle[i] = rand() % order;
+      for(j = 0; j < i && cycle[j] != cycle[i]; j++);
+    } while(cycle[i] == root || j < i);
+  }
+
+  int side = (int)sqrt((double)order);
+  double p = (double)degree / order;
+  printf("%d\n", order);
+  for(u = 0; u < order; u++) {
+    switch(type) {
+      case GEN_RANDOM:
+        for(i = 0; i < degree; i++) {
+          print_edge(rand() % order, random_weight(max_weight));
+        }
+        break;
+      case GEN_GRID:
+        // the vertices are laid out row by row, side per row (the last one may be shorter)
+        if(u % side > 0) {
+          print_edge(u - 1, random_weight(max_weight));
+        }
+        if(u % side < side - 1 && u + 1 < order) {
+          print_edge(u + 1, random_weight(max_weight));
+        }
+        if(u >= side) {
+          print_edge(u - side, random_weight(max_weight));
+        }
+        if(u + side < order) {
+          print_edge(u + side, random_weight(max_weight));
+        }
+        break;
+      case GEN_DENSE:
+        for(v = 0; v < order; v++) {
+          if(v != u && (double)rand() / ((double)RAND_MAX + 1.0) < p) {
+            print_edge(v, random_weight(max_weight));
+          }
+        }
+        break;
+      case GEN_NEGATIVE:
+      case GEN_NEGCYCLE:
+        for(i = 0; i < degree; i++) {
+          v = rand() % order;
+          print_edge(v, random_weight(max_weight) + potential[u] - potential[v]);
+        }
+        if(type == GEN_NEGCYCLE) {
+          if(u == root) {
+            print_edge(cycle[0], 1.0);
+          }
+          for(i = 0; i < 3; i++) {
+            if(u == cycle[i]) {
+              print_edge(cycle[(i + 1) % 3], -1.0);
+            }
+          }
+        }
+        break;
+    }
+    putchar('\n');
+  }
+  printf("%d\n", root);
+
+  free(potential);
+  return 0;
+}
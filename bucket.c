@@ -0,0 +1,199 @@
+// Monotone priority queues of vertices for spt_s on non-negative weights
+/*
+ * bucket.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "bucket.h"
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+DialQueue* dial_new(int capacity, float width, float max_weight) {
+  DialQueue *q = (DialQueue *)malloc(sizeof(DialQueue));
+  if(!q) {
+    g_error("DialQueue can't be alloc'd");
+  }
+  // one more bucket than strictly needed, to absorb rounding errors
+  // in the computation of the bucket of a label
+  // (computed in double, since the ratio can be well beyond an int)
+  double n_buckets = floor((double)max_weight / width) + 3;
+  if(!(n_buckets <= G_MAXINT)) {
+    g_error("The Dial queue would need %.0f buckets: the weights span too wide a range", n_buckets);
+  }
+  q->n_buckets = (int)n_buckets;
+  q->count = 0;
+  q->current = 0;
+  q->width = width;
+  q->head = (int *)malloc(q->n_buckets * sizeof(int));
+  q->next = (int *)malloc(capacity * sizeof(int));
+  q->prev = (int *)malloc(capacity * sizeof(int));
+  q->bucket = (gint64 *)malloc(capacity * sizeof(gint64));
+  if(!q->head || ((!q->next || !q->prev || !q->bucket) && capacity > 0)) {
+    g_error("Failed to alloc Dial queue arrays");
+  }
+  int i;
+  for(i = 0; i < q->n_buckets; i++) {
+    q->head[i] = -1;
+  }
+  for(i = 0; i < capacity; i++) {
+    q->bucket[i] = NO_BUCKET;
+  }
+  return q;
+}
+
+// removes v from its bucket's list
+static void dial_unlink(DialQueue *q, int v) {
+  if(q->prev[v] != -1) {
+    q->next[q->prev[v]] = q->next[v];
+  }
+  else {
+    q->head[q->bucket[v] % q->n_buckets] = q->next[v];
+  }
+  if(q->next[v] != -1) {
+    q->prev[q->next[v]] = q->prev[v];
+  }
+}
+
+void dial_push(DialQueue *q, int v, float label) {
+  gint64 b = (gint64)(label / q->width);
+  // a label can't go below the current bucket, unless by rounding errors
+  if(b < q->current) {
+    b = q->current;
+  }
+  if(q->bucket[v] == b) {
+    return;
+  }
+  if(q->bucket[v] != NO_BUCKET) {
+    dial_unlink(q, v);
+  }
+  else {
+    q->count++;
+  }
+  // v becomes the head of bucket b
+  int slot = b % q->n_buckets;
+  q->bucket[v] = b;
+  q->prev[v] = -1;
+  q->next[v] = q->head[slot];
+  if(q->head[slot] != -1) {
+    q->prev[q->head[slot]] = v;
+  }
+  q->head[slot] = v;
+}
+
+int dial_pop(DialQueue *q) {
+  // advance to the lowest non-empty bucket: at most n_buckets steps
+  while(q->head[q->current % q->n_buckets] == -1) {
+    q->current++;
+  }
+  int v = q->head[q->current % q->n_buckets];
+  dial_unlink(q, v);
+  q->bucket[v] = NO_BUCKET;
+  q->count--;
+  return v;
+}
+
+void dial_free(DialQueue *q) {
+  free(q->head);
+  free(q->next);
+  free(q->prev);
+  free(q->bucket);
+  free(q);
+}
+
+// the bits of a non-negative float, compared as an unsigned integer
+// (adding 0.0 turns -0.0 into 0.0)
+static guint32 float_key(float label) {
+  guint32 key;
+  label += 0.0f;
+  memcpy(&key, &label, sizeof(key));
+  return key;
+}
+
+// the bucket of key, relative to the last extracted key
+static int radix_bucket(guint32 key, guint32 last) {
+  if(key == last) {
+    return 0;
+  }
+  return g_bit_storage(key ^ last);
+}
+
+static void radix_append(RadixHeap *h, int b, RadixEntry entry) {
+  if(h->len[b] == h->cap[b]) {
+    h->cap[b] = h->cap[b] > 0 ? 2 * h->cap[b] : 16;
+    h->buckets[b] = (RadixEntry *)realloc(h->buckets[b], h->cap[b] * sizeof(RadixEntry));
+    if(!h->buckets[b]) {
+      g_error("Failed to grow radix heap bucket");
+    }
+  }
+  h->buckets[b][h->len[b]++] = entry;
+}
+
+RadixHeap* radix_new(void) {
+  RadixHeap *h = (RadixHeap *)calloc(1, sizeof(RadixHeap));
+  if(!h) {
+    g_error("RadixHeap can't be alloc'd");
+  }
+  return h;
+}
+
+void radix_push(RadixHeap *h, int v, float label) {
+  RadixEntry entry;
+  entry.key = float_key(label);
+  entry.vertex = v;
+  radix_append(h, radix_bucket(entry.key, h->last), entry);
+  h->size++;
+}
+
+int radix_pop(RadixHeap *h, float *label) {
+  int b, k;
+  if(h->len[0] == 0) {
+    // find the first non-empty bucket and its minimum key, which becomes
+    // the new last key: then all of its entries move to lower buckets
+    for(b = 1; h->len[b] == 0; b++)
+      ;
+    RadixEntry *bucket = h->buckets[b];
+    guint32 min = bucket[0].key;
+    for(k = 1; k < h->len[b]; k++) {
+      if(bucket[k].key < min) {
+        min = bucket[k].key;
+      }
+    }
+    h->last = min;
+    for(k = 0; k < h->len[b]; k++) {
+      radix_append(h, radix_bucket(bucket[k].key, min), bucket[k]);
+    }
+    h->len[b] = 0;
+  }
+  RadixEntry top = h->buckets[0][--h->len[0]];
+  h->size--;
+  memcpy(label, &top.key, sizeof(float));
+  return top.vertex;
+}
+
+void radix_free(RadixHeap *h) {
+  int b;
+  for(b = 0; b < RADIX_BUCKETS; b++) {
+    free(h->buckets[b]);
+  }
+  free(h);
+}
@@ -0,0 +1,93 @@
+// Monotone priority queues of vertices for spt_s on non-negative weights (header file)
+// The Dial queue is a circular array of buckets of fixed width, the radix heap
+// keeps its buckets by the highest bit that differs from the last extracted key
+/*
+ * bucket.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUCKET_DEFINED
+#define BUCKET_DEFINED
+
+#include <glib.h>
+
+#define NO_BUCKET -1 // bucket of a vertex that is not in the queue
+
+// Dial's bucket queue: bucket b holds the vertices whose label is in
+// [b * width, (b + 1) * width). If width is the minimum edge weight, no vertex
+// can improve another vertex of the same bucket, so the vertices of the
+// lowest non-empty bucket can be extracted in any order.
+// Since labels in the queue span at most max_weight, the buckets are
+// reused circularly: only max_weight / width + 2 of them are needed
+// Each bucket is a doubly linked list threaded through the vertices,
+// so both insertion and decrease-key are O(1)
+typedef struct dial_t {
+  int n_buckets; // the number of (circular) buckets
+  int count; // the number of vertices in the queue
+  gint64 current; // the (absolute) index of the lowest bucket that may be non-empty
+  float width; // the width of each bucket
+  int *head; // head[b % n_buckets] is the first vertex in bucket b, or -1
+  int *next; // the next vertex in the same bucket, or -1
+  int *prev; // the previous vertex in the same bucket, or -1
+  gint64 *bucket; // the (absolute) bucket of each vertex, or NO_BUCKET
+} DialQueue;
+
+// creates an empty Dial queue for the vertices 0 .. capacity - 1
+// width must be > 0: in spt_s it's the minimum edge weight
+DialQueue* dial_new(int capacity, float width, float max_weight);
+// inserts v with the given label, or moves it to the bucket of its new label
+void dial_push(DialQueue *q, int v, float label);
+// removes and returns a vertex from the lowest non-empty bucket
+int dial_pop(DialQueue *q);
+void dial_free(DialQueue *q);
+
+// An entry of the radix heap: the key is the bit pattern of a non-negative float,
+// which grows with the float it represents
+typedef struct radix_entry_t {
+  guint32 key;
+  int vertex;
+} RadixEntry;
+
+// the number of buckets: bucket 0 holds the keys equal to the last extracted one,
+// bucket i > 0 those whose highest bit differing from it is bit i - 1
+#define RADIX_BUCKETS 33
+
+// Radix heap: keys must never be smaller than the last extracted one (monotone)
+// which is true for Dijkstra on non-negative weights. There is no decrease-key:
+// a vertex is pushed again with its new label and the stale entries are
+// skipped by the caller (their key differs from the vertex's label)
+typedef struct radix_heap_t {
+  int size; // the number of entries (stale ones included)
+  guint32 last; // the last extracted key
+  RadixEntry *buckets[RADIX_BUCKETS];
+  int len[RADIX_BUCKETS];
+  int cap[RADIX_BUCKETS];
+} RadixHeap;
+
+RadixHeap* radix_new(void);
+// inserts v with key label (>= 0 and >= the last extracted key)
+void radix_push(RadixHeap *h, int v, float label);
+// removes and returns one of the entries with the smallest key
+// the key (as a float) is stored in *label
+int radix_pop(RadixHeap *h, float *label);
+void radix_free(RadixHeap *h);
+
+#define dial_is_empty(q) ((q)->count == 0)
+#define radix_is_empty(h) ((h)->size == 0)
+
+#endif
@@ -24,12 +24,25 @@
 
 // std lib  header for INFINITY: remember to link with -lm when compiling
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// POSIX headers to map the input file in memory
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// the size of the blocks read from an input that can't be mapped (pipes)
+#define READ_BLOCK_SIZE (1 << 20)
+// the size of the blocks of the arena of a Graph
+#define GRAPH_ARENA_BLOCK_SIZE (1 << 20)
 
 /*
-  Reads the graph from standard input with readline
+  Reads the graph from the input file, line by line
   Must be stored in an adjacency list format
 */
-Graph* new_graph(float *min_weight, float *max_weight) {
+Graph* new_graph(FILE *input, float *min_weight, float *max_weight) {
   // The graph is an adjacency list (doubly linked)
   // of nodes, which in turn contain a singly linked edge list
   Graph *g = (Graph *)malloc(sizeof(struct graph_t));
@@ -38,17 +51,22 @@ Graph* new_graph(float *min_weight, float *max_weight) {
   }
   g->order = 0;
   g->nodes = NULL;
+  // everything else is carved out of the arena
+  g->arena = arena_new(GRAPH_ARENA_BLOCK_SIZE);
 
   // reads the order (number of vertices), then the graph
   char* line = NULL;
-  line = readline("Enter the number of vertices: ");
+  size_t line_size = 0;
+  if(getline(&line, &line_size, input) == -1) {
+    g_error("The input doesn't start with the number of vertices");
+  }
   g->order = atoi(line); // assuming a valid integer
 
-  free(line);
-  line = NULL;
-
   // dummy list and other variables
   GSList* adjlist = NULL;
+  GSList* link = NULL;
+  GList* last = NULL; // the last node of the graph, to append in O(1)
+  GList* node_link = NULL;
   int dest = -1;
   float weight = 0;
   *min_weight = INFINITY; // store biggest value: greater than any float
@@ -59,25 +77,27 @@ Graph* new_graph(float *min_weight, float *max_weight) {
   int i;
 
   for (i = 0; i < g->order; i++) {
-      // reads a line containing the adjacency list of vertex i (no prompt)
-      line = readline(NULL);
+      // reads a line containing the adjacency list of vertex i
+      // (a missing line is the same as an empty one)
+      if(getline(&line, &line_size, input) == -1) {
+          line[0] = '\0';
+      }
 
-      // tokenizes the line: tokens are separated by " "
-      token = strtok(line, " ");
+      // tokenizes the line: tokens are separated by " " (the last one by "\n")
+      token = strtok(line, " \n");
 
       while (token) {
           // parses the token in the destination vertex and the edge's weight
           sscanf(token, "%d:%f", &dest, &weight);
-          // allocates memory for the edge
-          e = (Edge*)malloc(sizeof(Edge));
-          if (e == NULL) {
-              puts("Failed to alloc Edge");
-              exit(1);
-          }
+          // the edge and its link in the adjacency list
+          e = (Edge*)arena_alloc(g->arena, sizeof(Edge));
           e->destination = dest;
           e->weight = weight;
           // prepends the Edge e to the adjacency list
-          adjlist = g_slist_prepend(adjlist, e);
+          link = (GSList*)arena_alloc(g->arena, sizeof(GSList));
+          link->data = e;
+          link->next = adjlist;
+          adjlist = link;
 
           //update the max weight if greater than current
           if(*max_weight < weight) {
@@ -88,23 +108,26 @@ Graph* new_graph(float *min_weight, float *max_weight) {
           }
 
           // get the next token
-          token = strtok(NULL, " ");
+          token = strtok(NULL, " \n");
       }
-      // input line freed
-      free(line);
 
       // Alloc another node
-      n = (Node*)malloc(sizeof(Node));
-      if (!n) {
-          puts("Failed to alloc Node");
-          exit(1);
-      }
+      n = (Node*)arena_alloc(g->arena, sizeof(Node));
       // Initialize the node with its label and the adjlist
       n->vertex = i;
       n->adjacent = adjlist;
       // Then append to the graph
-      // TODO: maybe prepend then reverse at the end
-      g->nodes = g_list_append(g->nodes, n);
+      node_link = (GList*)arena_alloc(g->arena, sizeof(GList));
+      node_link->data = n;
+      node_link->next = NULL;
+      node_link->prev = last;
+      if(last) {
+          last->next = node_link;
+      }
+      else {
+          g->nodes = node_link;
+      }
+      last = node_link;
 
       // then the adjacency list is resetted without deallocating anything
       adjlist = NULL;
@@ -112,6 +135,8 @@ Graph* new_graph(float *min_weight, float *max_weight) {
   }
   // dummy list set to NULL just to be safe
   adjlist = NULL;
+  // input line freed
+  free(line);
 
   return g;
 }
@@ -133,68 +158,619 @@ void print_graph(FILE *target, Graph g) {
     }
 }
 
-// a new node is added as a super root, connecting it with edges
-// of weight 0 to all the nodes in the supplied GArray
-// !!The node is predended to the list of nodes!!
-int graph_add_hyper_root(Graph *G, GArray *roots) {
-  // first build the adjacency list of the super-root
-  int i, lenght = roots->len;
-  GSList *adjlist = NULL;
+CsrGraph* csr_graph_from_graph(const Graph *g) {
+  CsrGraph *csr = (CsrGraph *)malloc(sizeof(CsrGraph));
+  if(!csr) {
+    g_error("CsrGraph can't be alloc'd");
+  }
+  csr->order = g->order;
+  csr->min_weight = INFINITY;
+  csr->max_weight = -INFINITY;
+  csr->mapping = NULL;
+  csr->mapping_size = 0;
+  csr->offsets = (int *)malloc((g->order + 1) * sizeof(int));
+  if(!csr->offsets) {
+    g_error("Failed to alloc CSR offsets");
+  }
+
+  // first pass: count the edges of each vertex to compute the offsets
+  // (offsets[i + 1] temporarily holds the degree of vertex i)
+  GList *iter = NULL;
+  Node *n = NULL;
+  int i;
+  for(i = 0; i <= g->order; i++) {
+    csr->offsets[i] = 0;
+  }
+  for(iter = g->nodes; iter != NULL; iter = iter->next) {
+    n = iter->data;
+    csr->offsets[n->vertex + 1] = g_slist_length(n->adjacent);
+  }
+  for(i = 0; i < g->order; i++) {
+    csr->offsets[i + 1] += csr->offsets[i];
+  }
+  csr->size = csr->offsets[g->order];
+
+  csr->dest = (int *)malloc(csr->size * sizeof(int));
+  csr->weight = (float *)malloc(csr->size * sizeof(float));
+  if((!csr->dest || !csr->weight) && csr->size > 0) {
+    g_error("Failed to alloc CSR edge arrays");
+  }
+
+  // second pass: copy the edges, each adjacency list in its own slice
+  GSList *adj = NULL;
   Edge *e = NULL;
-  for(i = 0; i < lenght; i++) {
-    e = (Edge *)malloc(sizeof(Edge));
-    if(!e) {
-      g_error("Failed to alloc Edge");
+  int k;
+  for(iter = g->nodes; iter != NULL; iter = iter->next) {
+    n = iter->data;
+    k = csr->offsets[n->vertex];
+    for(adj = n->adjacent; adj != NULL; adj = adj->next) {
+      e = adj->data;
+      csr->dest[k] = e->destination;
+      csr->weight[k] = e->weight;
+      if(csr->max_weight < e->weight) {
+        csr->max_weight = e->weight;
+      }
+      if(csr->min_weight > e->weight) {
+        csr->min_weight = e->weight;
+      }
+      k++;
+    }
+  }
+
+  return csr;
+}
+
+void print_csr_graph(FILE *target, const CsrGraph *g) {
+  int i, k;
+  for(i = 0; i < g->order; i++) {
+    fprintf(target, "%d -> ", i);
+    for(k = g->offsets[i]; k < g->offsets[i + 1]; k++) {
+      fprintf(target, "%d (%.3f), ", g->dest[k], g->weight[k]);
     }
-    // set the edge's head to the i-th root with edge weight 0
-    e->destination = g_array_index(roots, int, i);
-    e->weight = 0.0;
-    // prepend the edge to the adjacency list of the node
-    adjlist = g_slist_prepend(adjlist, e);
+    fputc('\n', target);
+  }
+}
+
+CsrGraph* csr_graph_reverse(const CsrGraph *g) {
+  CsrGraph *r = (CsrGraph *)malloc(sizeof(CsrGraph));
+  if(!r) {
+    g_error("CsrGraph can't be alloc'd");
+  }
+  r->order = g->order;
+  r->size = g->size;
+  r->min_weight = g->min_weight;
+  r->max_weight = g->max_weight;
+  r->mapping = NULL;
+  r->mapping_size = 0;
+  r->offsets = (int *)calloc(g->order + 1, sizeof(int));
+  r->dest = (int *)malloc(g->size * sizeof(int));
+  r->weight = (float *)malloc(g->size * sizeof(float));
+  if(!r->offsets || ((!r->dest || !r->weight) && g->size > 0)) {
+    g_error("Failed to alloc reverse CSR arrays");
   }
 
-  Node *n = (Node *)malloc(sizeof(Node));
-  if(!n) {
-    g_error("Failed to alloc Node");
+  // first pass: count the edges entering each vertex
+  int u, k;
+  for(k = 0; k < g->size; k++) {
+    r->offsets[g->dest[k] + 1]++;
   }
-  // then set the node's adjacency list to the one created in the loop
-  n->vertex = G->order; // the new super-root is set to be the next available integer
-  n->adjacent = adjlist;
-  // then add the node to the graph and update it consequently
-  G->order += 1;
-  G->nodes = g_list_prepend(G->nodes, n);
+  for(u = 0; u < g->order; u++) {
+    r->offsets[u + 1] += r->offsets[u];
+  }
+  // second pass: the edge u -> v goes in v's slice, in the order of u
+  // (offsets[v] is used as the next free slot of v, then shifted back)
+  for(u = 0; u < g->order; u++) {
+    for(k = g->offsets[u]; k < g->offsets[u + 1]; k++) {
+      int slot = r->offsets[g->dest[k]]++;
+      r->dest[slot] = u;
+      r->weight[slot] = g->weight[k];
+    }
+  }
+  for(u = g->order; u > 0; u--) {
+    r->offsets[u] = r->offsets[u - 1];
+  }
+  r->offsets[0] = 0;
 
-  return G->order - 1;
+  return r;
 }
 
-void graph_remove_hyper_root(Graph *g) {
-    // the hyper-root is the first node in the GList and must be removed
-    // First get a link to it
-    GList *hyroot = g->nodes;
-    // then free the data contained in that GList node
-    node_free(hyroot->data);
-    // then delete (remove + free) the list's node
-    // NOTE: do not swap this and the line above: data becomes unreachable,
-    // even though it doesn't leak either way (see valgrind output)
-    g->nodes = g_list_delete_link(g->nodes, hyroot);
+// copies the arrays of a graph read from a binary file out of the (read-only) mapping
+static void csr_graph_detach(CsrGraph *g) {
+  int *offsets = (int *)malloc((g->order + 1) * sizeof(int));
+  int *dest = (int *)malloc(g->size * sizeof(int));
+  float *weight = (float *)malloc(g->size * sizeof(float));
+  if(!offsets || ((!dest || !weight) && g->size > 0)) {
+    g_error("Failed to alloc CSR arrays");
+  }
+  memcpy(offsets, g->offsets, (g->order + 1) * sizeof(int));
+  memcpy(dest, g->dest, g->size * sizeof(int));
+  memcpy(weight, g->weight, g->size * sizeof(float));
+  munmap(g->mapping, g->mapping_size);
+  g->offsets = offsets;
+  g->dest = dest;
+  g->weight = weight;
+  g->mapping = NULL;
+  g->mapping_size = 0;
 }
 
-void edge_free(gpointer data) {
-  if(data != NULL) {
-    free((Edge *)data);
+// updates the bounds on the weights of g with a new weight
+static inline void csr_graph_bound_weight(CsrGraph *g, float weight) {
+  if(!isinf(weight)) {
+    g->min_weight = MIN(g->min_weight, weight);
+    g->max_weight = MAX(g->max_weight, weight);
   }
 }
 
-void node_free(gpointer data) {
-  // just frees the adjacency list of this node
-  g_slist_free_full(((Node *)data)->adjacent, edge_free);
-  // then the node itself is freed
-  free((Node *)data);
+gboolean csr_graph_set_weight(CsrGraph *g, int from, int to, float weight, float *old) {
+  if(from < 0 || from >= g->order || to < 0 || to >= g->order) {
+    g_error("Edge %d -> %d out of a graph of %d vertices", from, to, g->order);
+  }
+  if(g->mapping) {
+    csr_graph_detach(g);
+  }
+  int k;
+  for(k = g->offsets[from]; k < g->offsets[from + 1]; k++) {
+    if(g->dest[k] == to) {
+      *old = g->weight[k];
+      g->weight[k] = weight;
+      csr_graph_bound_weight(g, weight);
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+void csr_graph_insert_edges(CsrGraph *g, const CsrEdge *edges, int n) {
+  if(n == 0) {
+    return;
+  }
+  int u, i, k;
+  for(i = 0; i < n; i++) {
+    if(edges[i].from < 0 || edges[i].from >= g->order
+       || edges[i].to < 0 || edges[i].to >= g->order) {
+      g_error("Edge %d -> %d out of a graph of %d vertices", edges[i].from, edges[i].to, g->order);
+    }
+  }
+  if(g->mapping) {
+    csr_graph_detach(g);
+  }
+  // the new offsets: count the new edges of each vertex
+  int *offsets = (int *)calloc(g->order + 1, sizeof(int));
+  int *dest = (int *)malloc((g->size + n) * sizeof(int));
+  float *weight = (float *)malloc((g->size + n) * sizeof(float));
+  if(!offsets || !dest || !weight) {
+    g_error("Failed to alloc CSR arrays");
+  }
+  for(i = 0; i < n; i++) {
+    offsets[edges[i].from + 1]++;
+  }
+  for(u = 0; u < g->order; u++) {
+    offsets[u + 1] += offsets[u] + (g->offsets[u + 1] - g->offsets[u]);
+  }
+  // the old edges of each vertex are copied, then the new ones follow
+  // (offsets[u] is used as the next free slot of u, then shifted back)
+  for(u = 0; u < g->order; u++) {
+    k = g->offsets[u + 1] - g->offsets[u];
+    memcpy(dest + offsets[u], g->dest + g->offsets[u], k * sizeof(int));
+    memcpy(weight + offsets[u], g->weight + g->offsets[u], k * sizeof(float));
+    offsets[u] += k;
+  }
+  for(i = 0; i < n; i++) {
+    k = offsets[edges[i].from]++;
+    dest[k] = edges[i].to;
+    weight[k] = edges[i].weight;
+    csr_graph_bound_weight(g, edges[i].weight);
+  }
+  for(u = g->order; u > 0; u--) {
+    offsets[u] = offsets[u - 1];
+  }
+  offsets[0] = 0;
+
+  free(g->offsets);
+  free(g->dest);
+  free(g->weight);
+  g->offsets = offsets;
+  g->dest = dest;
+  g->weight = weight;
+  g->size += n;
+}
+
+CsrGraph* csr_graph_from_edges(int order, const CsrEdge *edges, int n) {
+  int i;
+  if(order < 0 || n < 0) {
+    return NULL;
+  }
+  for(i = 0; i < n; i++) {
+    if(edges[i].from < 0 || edges[i].from >= order
+       || edges[i].to < 0 || edges[i].to >= order) {
+      return NULL;
+    }
+  }
+  CsrGraph *csr = (CsrGraph *)malloc(sizeof(CsrGraph));
+  if(!csr) {
+    g_error("CsrGraph can't be alloc'd");
+  }
+  // an empty graph, then all the edges are inserted at once
+  csr->order = order;
+  csr->size = 0;
+  csr->min_weight = INFINITY;
+  csr->max_weight = -INFINITY;
+  csr->mapping = NULL;
+  csr->mapping_size = 0;
+  csr->offsets = (int *)calloc(order + 1, sizeof(int));
+  if(!csr->offsets) {
+    g_error("Failed to alloc CSR offsets");
+  }
+  csr->dest = NULL;
+  csr->weight = NULL;
+  csr_graph_insert_edges(csr, edges, n);
+  return csr;
+}
+
+void csr_graph_free(CsrGraph *g) {
+  if(g->mapping) {
+    // the arrays are in the mapping of the binary file
+    munmap(g->mapping, g->mapping_size);
+  }
+  else {
+    free(g->offsets);
+    free(g->dest);
+    free(g->weight);
+  }
+  free(g);
+}
+
+// Hand-written scanner for the text format: it works directly on the
+// (mapped) input, without copying lines or tokens
+
+// exact powers of ten representable as doubles
+static const double pow10_table[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// skips blanks (but not newlines)
+static const char* skip_blanks(const char *p, const char *end) {
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+    p++;
+  }
+  return p;
+}
+
+// parses a (possibly signed) decimal integer: returns the first char after
+// it, or NULL if there are no digits
+static const char* scan_int(const char *p, const char *end, int *value) {
+  int sign = 1;
+  long v = 0;
+  if(p < end && (*p == '-' || *p == '+')) {
+    sign = (*p == '-' ? -1 : 1);
+    p++;
+  }
+  const char *digits = p;
+  while(p < end && *p >= '0' && *p <= '9') {
+    v = v * 10 + (*p - '0');
+    if(v > G_MAXINT) {
+      return NULL;
+    }
+    p++;
+  }
+  if(p == digits) {
+    return NULL;
+  }
+  *value = (int)(sign * v);
+  return p;
+}
+
+// parses a real number as [sign] digits [. digits] [e [sign] digits]
+// returns the first char after it, or NULL if it's malformed
+// The significant digits are accumulated in an integer and scaled by
+// an exact power of ten, so the result is correctly rounded for the
+// usual inputs (up to 15 significant digits)
+static const char* scan_float(const char *p, const char *end, float *value) {
+  gboolean negative = FALSE;
+  guint64 mantissa = 0;
+  int exp10 = 0, n_digits = 0, exp_value;
+  if(p < end && (*p == '-' || *p == '+')) {
+    negative = (*p == '-');
+    p++;
+  }
+  for(; p < end && *p >= '0' && *p <= '9'; p++, n_digits++) {
+    if(mantissa < G_GUINT64_CONSTANT(1000000000000000000)) {
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+    else {
+      exp10++; // digits that don't fit only scale the number
+    }
+  }
+  if(p < end && *p == '.') {
+    for(p++; p < end && *p >= '0' && *p <= '9'; p++, n_digits++) {
+      if(mantissa < G_GUINT64_CONSTANT(1000000000000000000)) {
+        mantissa = mantissa * 10 + (*p - '0');
+        exp10--;
+      }
+    }
+  }
+  if(n_digits == 0) {
+    return NULL;
+  }
+  if(p < end && (*p == 'e' || *p == 'E')) {
+    p = scan_int(p + 1, end, &exp_value);
+    if(!p) {
+      return NULL;
+    }
+    exp10 += exp_value;
+  }
+
+  double v = (double)mantissa;
+  if(exp10 >= 0 && exp10 <= 22) {
+    v *= pow10_table[exp10];
+  }
+  else if(exp10 < 0 && exp10 >= -22) {
+    v /= pow10_table[-exp10];
+  }
+  else {
+    v *= pow(10.0, exp10);
+  }
+  *value = (float)(negative ? -v : v);
+  return p;
+}
+
+// Parses a graph in the text format (see new_graph) from [text, end)
+// into a CSR graph, filling the edge arrays directly
+// *graph_end is set to the first char after the graph
+static CsrGraph* csr_graph_parse(const char *text, const char *end, const char **graph_end) {
+  const char *p = skip_blanks(text, end);
+  int order;
+  p = scan_int(p, end, &order);
+  if(!p || order < 0) {
+    g_error("The input doesn't start with the number of vertices");
+  }
+
+  // there is one ':' per edge, so counting them gives the size of the
+  // edge arrays (the roots that may follow the graph contain none)
+  int capacity = 0;
+  const char *c = p;
+  while((c = memchr(c, ':', end - c)) != NULL) {
+    capacity++;
+    c++;
+  }
+
+  CsrGraph *g = (CsrGraph *)malloc(sizeof(CsrGraph));
+  if(!g) {
+    g_error("CsrGraph can't be alloc'd");
+  }
+  g->order = order;
+  g->min_weight = INFINITY;
+  g->max_weight = -INFINITY;
+  g->mapping = NULL;
+  g->mapping_size = 0;
+  g->offsets = (int *)malloc((order + 1) * sizeof(int));
+  g->dest = (int *)malloc(capacity * sizeof(int));
+  g->weight = (float *)malloc(capacity * sizeof(float));
+  if(!g->offsets || ((!g->dest || !g->weight) && capacity > 0)) {
+    g_error("Failed to alloc CSR arrays");
+  }
+
+  // skip the rest of the first line
+  p = memchr(p, '\n', end - p);
+  p = (p ? p + 1 : end);
+
+  int i, k = 0, first, last, tmp_dest;
+  float tmp_weight;
+  for(i = 0; i < order; i++) {
+    g->offsets[i] = k;
+    // the i-th line is the adjacency list of vertex i: "dest:weight" tokens
+    while(1) {
+      p = skip_blanks(p, end);
+      if(p == end || *p == '\n') {
+        break;
+      }
+      p = scan_int(p, end, &g->dest[k]);
+      if(!p || p == end || *p != ':' || !(p = scan_float(p + 1, end, &g->weight[k]))) {
+        g_error("Malformed edge in the adjacency list of vertex %d", i);
+      }
+      if(g->dest[k] < 0 || g->dest[k] >= order) {
+        g_error("Vertex %d has an edge to %d, which is not a vertex", i, g->dest[k]);
+      }
+      if(g->max_weight < g->weight[k]) {
+        g->max_weight = g->weight[k];
+      }
+      if(g->min_weight > g->weight[k]) {
+        g->min_weight = g->weight[k];
+      }
+      k++;
+    }
+    if(p < end) {
+      p++; // the newline
+    }
+    // the edges are stored last to first, like the lists built by new_graph
+    // (which prepends them), so the algorithms scan them in the same order
+    for(first = g->offsets[i], last = k - 1; first < last; first++, last--) {
+      tmp_dest = g->dest[first];
+      g->dest[first] = g->dest[last];
+      g->dest[last] = tmp_dest;
+      tmp_weight = g->weight[first];
+      g->weight[first] = g->weight[last];
+      g->weight[last] = tmp_weight;
+    }
+  }
+  g->offsets[order] = k;
+  g->size = k;
+  *graph_end = p;
+
+  return g;
+}
+
+// checks whether [data, data + len) starts with the header of a binary graph
+static gboolean is_binary_graph(const char *data, size_t len) {
+  return len >= sizeof(CsrHeader) && memcmp(data, CSR_MAGIC, 4) == 0;
+}
+
+// Builds a CSR graph from the binary format in [data, data + len)
+// If copy is FALSE the arrays point into data, which must outlive the graph
+static CsrGraph* csr_graph_from_binary(const char *data, size_t len, gboolean copy) {
+  CsrHeader header;
+  memcpy(&header, data, sizeof(CsrHeader));
+  if(header.version != CSR_VERSION) {
+    g_error("Unsupported binary graph version %u (or wrong byte order)", header.version);
+  }
+  size_t offsets_len = ((size_t)header.order + 1) * sizeof(int);
+  size_t edges_len = (size_t)header.size * sizeof(int);
+  if(header.order < 0 || header.size < 0
+     || len != sizeof(CsrHeader) + offsets_len + 2 * edges_len) {
+    g_error("Truncated or corrupted binary graph");
+  }
+
+  CsrGraph *g = (CsrGraph *)malloc(sizeof(CsrGraph));
+  if(!g) {
+    g_error("CsrGraph can't be alloc'd");
+  }
+  g->order = header.order;
+  g->size = header.size;
+  g->min_weight = header.min_weight;
+  g->max_weight = header.max_weight;
+  g->mapping = NULL;
+  g->mapping_size = 0;
+  const char *arrays = data + sizeof(CsrHeader);
+  if(copy) {
+    g->offsets = (int *)malloc(offsets_len);
+    g->dest = (int *)malloc(edges_len);
+    g->weight = (float *)malloc(edges_len);
+    if(!g->offsets || ((!g->dest || !g->weight) && g->size > 0)) {
+      g_error("Failed to alloc CSR arrays");
+    }
+    memcpy(g->offsets, arrays, offsets_len);
+    memcpy(g->dest, arrays + offsets_len, edges_len);
+    memcpy(g->weight, arrays + offsets_len + edges_len, edges_len);
+  }
+  else {
+    // the CSR graph is immutable, so the arrays can be used in place
+    g->offsets = (int *)arrays;
+    g->dest = (int *)(arrays + offsets_len);
+    g->weight = (float *)(arrays + offsets_len + edges_len);
+  }
+  if(g->offsets[0] != 0 || g->offsets[g->order] != g->size) {
+    g_error("Corrupted binary graph: inconsistent offsets");
+  }
+  // the algorithms index the arrays with these values without checking them,
+  // as the text parser checks them while reading
+  int i;
+  for(i = 0; i < g->order; i++) {
+    if(g->offsets[i] > g->offsets[i + 1]) {
+      g_error("Corrupted binary graph: decreasing offsets at vertex %d", i);
+    }
+  }
+  for(i = 0; i < g->size; i++) {
+    if(g->dest[i] < 0 || g->dest[i] >= g->order) {
+      g_error("Corrupted binary graph: edge %d goes to %d, out of %d vertices", i, g->dest[i], g->order);
+    }
+  }
+  return g;
+}
+
+void csr_graph_save(const CsrGraph *g, const char *path) {
+  FILE *out = fopen(path, "wb");
+  if(!out) {
+    g_error("Can't open %s for writing", path);
+  }
+  CsrHeader header;
+  memset(&header, 0, sizeof(CsrHeader));
+  memcpy(header.magic, CSR_MAGIC, 4);
+  header.version = CSR_VERSION;
+  header.order = g->order;
+  header.size = g->size;
+  header.min_weight = g->min_weight;
+  header.max_weight = g->max_weight;
+  if(fwrite(&header, sizeof(CsrHeader), 1, out) != 1
+     || fwrite(g->offsets, sizeof(int), g->order + 1, out) != (size_t)g->order + 1
+     || fwrite(g->dest, sizeof(int), g->size, out) != (size_t)g->size
+     || fwrite(g->weight, sizeof(float), g->size, out) != (size_t)g->size
+     || fclose(out) != 0) {
+    g_error("Failed to write the graph to %s", path);
+  }
+}
+
+CsrGraph* csr_graph_load(const char *path, size_t *bytes_read, char **trailer) {
+  // "-" is the standard input
+  int fd = (strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY));
+  if(fd == -1) {
+    g_error("Can't open %s", path);
+  }
+  const char *graph_end = NULL;
+  if(trailer) {
+    *trailer = NULL;
+  }
+  struct stat info;
+  if(fstat(fd, &info) == -1) {
+    g_error("Can't stat %s", path);
+  }
+
+  CsrGraph *g = NULL;
+  if(S_ISREG(info.st_mode) && info.st_size > 0) {
+    // a regular file is mapped in memory and parsed in place
+    char *text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(text == MAP_FAILED) {
+      g_error("Can't map %s in memory", path);
+    }
+    if(is_binary_graph(text, info.st_size)) {
+      // the graph keeps the mapping: it's released by csr_graph_free
+      g = csr_graph_from_binary(text, info.st_size, FALSE);
+      g->mapping = text;
+      g->mapping_size = info.st_size;
+    }
+    else {
+      madvise(text, info.st_size, MADV_SEQUENTIAL);
+      g = csr_graph_parse(text, text + info.st_size, &graph_end);
+      if(trailer) {
+        *trailer = g_strndup(graph_end, text + info.st_size - graph_end);
+      }
+      munmap(text, info.st_size);
+    }
+    *bytes_read = info.st_size;
+  }
+  else {
+    // anything else (a pipe, stdin) is read in large blocks until EOF
+    size_t len = 0, capacity = READ_BLOCK_SIZE;
+    ssize_t n;
+    char *text = (char *)malloc(capacity);
+    if(!text) {
+      g_error("Failed to alloc the input buffer");
+    }
+    while((n = read(fd, text + len, capacity - len)) > 0) {
+      len += n;
+      if(len == capacity) {
+        capacity *= 2;
+        text = (char *)realloc(text, capacity);
+        if(!text) {
+          g_error("Failed to grow the input buffer");
+        }
+      }
+    }
+    if(n == -1) {
+      g_error("Can't read %s", path);
+    }
+    if(is_binary_graph(text, len)) {
+      g = csr_graph_from_binary(text, len, TRUE);
+    }
+    else {
+      g = csr_graph_parse(text, text + len, &graph_end);
+      if(trailer) {
+        *trailer = g_strndup(graph_end, text + len - graph_end);
+      }
+    }
+    free(text);
+    *bytes_read = len;
+  }
+  if(fd != STDIN_FILENO) {
+    close(fd);
+  }
+
+  return g;
 }
 
 void graph_free(Graph *g) {
-  // frees the nodes list
-  g_list_free_full(g->nodes, node_free);
-  // and then the graph itseff
+  // the nodes, the edges and the links of the lists are all in the arena
+  arena_free(g->arena);
+  // and then the graph itself
   free(g);
 }
@@ -24,8 +24,12 @@
 
 // Glib headers (both GList and GSList are used)
 #include <glib.h>
-// readline is used to read the input graph
-#include <readline/readline.h>
+// the nodes, edges and list links of a Graph are allocated in an arena
+#include "arena.h"
+// the CSR graph, with csr_graph_load, csr_graph_from_edges and csr_graph_free
+#include "libspt.h"
+
+#include <stdio.h>
 
 // Edge structure
 typedef struct edge_t {
@@ -38,27 +42,59 @@ typedef struct node_t {
     GSList* adjacent;
 } Node;
 // The graph is just a list of nodes
+// The nodes, the edges and the links of both lists live in the arena, so
+// the graph is released with a few calls to free: the lists must not be
+// modified with the GLib functions, which would free their links one by one
 typedef struct graph_t {
   int order;
   GList *nodes;
+  Arena *arena;
 } Graph;
+/*  Binary graph format (version 1), in the byte order of the machine that wrote it:
+    a CsrHeader, followed by the arrays offsets[order + 1], dest[size], weight[size]
+    (32 bit integers and floats). The file can be mapped and used as it is
+*/
+#define CSR_MAGIC "SPTG" // the first four bytes of a binary graph file
+#define CSR_VERSION 1
+typedef struct csr_header_t {
+  char magic[4]; // CSR_MAGIC
+  guint32 version; // CSR_VERSION (the byte order is wrong if it reads differently)
+  gint32 order;
+  gint32 size;
+  float min_weight;
+  float max_weight;
+} CsrHeader;
 
-/* 	Generates a new graph
-	The parameter is a pointer to the max edge weight in the graph
-	that gets overwritten inside the function.
+/* 	Generates a new graph, reading it from input
+	The other parameters are pointers to the min and max edge weights in the graph
+	that get overwritten inside the function.
 	It's useful in algorithms such as SPT.L or SPT.S
 */
-Graph* new_graph(float *min_weight, float *max_weight);
+Graph* new_graph(FILE *input, float *min_weight, float *max_weight);
 /* Prints the graph to target, where target can be any open file descriptor */
 void print_graph(FILE *target, Graph g);
-// a new node is added as a super root, connecting it with edges
-// of weight 0 to all the nodes in the supplied GArray
-// Returns the index of the newly created node
-int graph_add_hyper_root(Graph *g, GArray *roots);
-// removes the hyper-root from the graph
-void graph_remove_hyper_root(Graph *g);
-void edge_free(gpointer edge);
-void node_free(gpointer node);
+// builds the CSR representation of g: the order of the edges in each
+// adjacency list is preserved, so the algorithms scan them in the same order
+CsrGraph* csr_graph_from_graph(const Graph *g);
+// writes g to the file at path in the binary format
+void csr_graph_save(const CsrGraph *g, const char *path);
+// builds the reverse of g: each edge u -> v of g becomes v -> u, with the same weight
+CsrGraph* csr_graph_reverse(const CsrGraph *g);
+/*  Sets the weight of the edge from -> to (the first one, if there are many)
+    and stores the old one in *old: returns FALSE if there's no such edge
+    A weight of INFINITY removes the edge, but it keeps its slot (no algorithm
+    relaxes it, and setting its weight again puts it back)
+    The bounds on the weights only grow
+    A graph read from a binary file is copied out of its mapping first
+*/
+gboolean csr_graph_set_weight(CsrGraph *g, int from, int to, float weight, float *old);
+// inserts the n edges in g, each after the other edges of its tail:
+// the arrays are rebuilt once for all of them
+// (this function and csr_graph_set_weight abort if an endpoint is not a vertex of g)
+void csr_graph_insert_edges(CsrGraph *g, const CsrEdge *edges, int n);
+/* Prints the CSR graph to target, in the same format as print_graph */
+void print_csr_graph(FILE *target, const CsrGraph *g);
+// frees g, with all its nodes and edges
 void graph_free(Graph *g);
 
 #endif
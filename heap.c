@@ -0,0 +1,156 @@
+// Indexed d-ary heap of vertices, used as the priority queue of spt_s
+/*
+ * heap.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "heap.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+
+Heap* heap_new(int capacity) {
+  Heap *h = (Heap *)malloc(sizeof(Heap));
+  if(!h) {
+    g_error("Heap can't be alloc'd");
+  }
+  h->size = 0;
+  h->capacity = capacity;
+  h->items = (HeapItem *)malloc(capacity * sizeof(HeapItem));
+  h->position = (int *)malloc(capacity * sizeof(int));
+  if((!h->items || !h->position) && capacity > 0) {
+    g_error("Failed to alloc heap arrays");
+  }
+  int i;
+  for(i = 0; i < capacity; i++) {
+    h->position[i] = NOT_IN_HEAP;
+  }
+  return h;
+}
+
+void heap_clear(Heap *h) {
+  int i;
+  for(i = 0; i < h->size; i++) {
+    h->position[h->items[i].vertex] = NOT_IN_HEAP;
+  }
+  h->size = 0;
+}
+
+// moves the item at index i towards the root while its key is smaller
+// than its parent's (the hole is moved instead of swapping at each level)
+static void sift_up(Heap *h, int i) {
+  HeapItem item = h->items[i];
+  int parent;
+  while(i > 0) {
+    parent = (i - 1) / HEAP_ARITY;
+    if(h->items[parent].key <= item.key) {
+      break;
+    }
+    h->items[i] = h->items[parent];
+    h->position[h->items[i].vertex] = i;
+    i = parent;
+  }
+  h->items[i] = item;
+  h->position[item.vertex] = i;
+}
+
+// moves the item at index i towards the leaves while its key is greater
+// than the smallest of its children's
+static void sift_down(Heap *h, int i) {
+  HeapItem item = h->items[i];
+  int child, last, smallest;
+  while(1) {
+    child = i * HEAP_ARITY + 1;
+    if(child >= h->size) {
+      break;
+    }
+    // find the child with the smallest key
+    last = MIN(child + HEAP_ARITY, h->size);
+    smallest = child;
+    for(child++; child < last; child++) {
+      if(h->items[child].key < h->items[smallest].key) {
+        smallest = child;
+      }
+    }
+    if(item.key <= h->items[smallest].key) {
+      break;
+    }
+    h->items[i] = h->items[smallest];
+    h->position[h->items[i].vertex] = i;
+    i = smallest;
+  }
+  h->items[i] = item;
+  h->position[item.vertex] = i;
+}
+
+void heap_push(Heap *h, int v, float key) {
+  h->items[h->size].vertex = v;
+  h->items[h->size].key = key;
+  h->size++;
+  sift_up(h, h->size - 1);
+}
+
+int heap_pop(Heap *h, float *key) {
+  HeapItem top = h->items[0];
+  h->position[top.vertex] = NOT_IN_HEAP;
+  h->size--;
+  if(h->size > 0) {
+    // the last item replaces the root and then sinks to its place
+    h->items[0] = h->items[h->size];
+    sift_down(h, 0);
+  }
+  if(key) {
+    *key = top.key;
+  }
+  return top.vertex;
+}
+
+void heap_decrease_key(Heap *h, int v, float key) {
+  int i = h->position[v];
+  h->items[i].key = key;
+  sift_up(h, i);
+}
+
+void heap_push_or_decrease(Heap *h, int v, float key) {
+  if(heap_contains(h, v)) {
+    heap_decrease_key(h, v, key);
+  }
+  else {
+    heap_push(h, v, key);
+  }
+}
+
+void heap_update_key(Heap *h, int v, float key) {
+  int i = h->position[v];
+  float old = h->items[i].key;
+  h->items[i].key = key;
+  if(key < old) {
+    sift_up(h, i);
+  }
+  else {
+    sift_down(h, i);
+  }
+}
+
+void heap_free(Heap *h) {
+  free(h->items);
+  free(h->position);
+  free(h);
+}
@@ -0,0 +1,76 @@
+// Indexed d-ary heap of vertices, used as the priority queue of spt_s (header file)
+/*
+ * heap.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEAP_DEFINED
+#define HEAP_DEFINED
+
+#include <glib.h>
+
+// The arity of the heap: can be changed at compile time (-D HEAP_ARITY=n)
+// A wider heap is shallower, so decrease-key (the most frequent operation
+// in Dijkstra) is cheaper, at the cost of more comparisons in pop
+#ifndef HEAP_ARITY
+#define HEAP_ARITY 4
+#endif
+
+#define NOT_IN_HEAP -1 // position of a vertex that is not in the heap
+
+// An item in the heap: the key is stored next to the vertex
+// so that sifting doesn't need to look anything up
+typedef struct heap_item_t {
+  float key;
+  int vertex;
+} HeapItem;
+
+// The heap can contain the vertices 0 .. capacity - 1, each at most once
+typedef struct heap_t {
+  int size; // the number of items currently in the heap
+  int capacity;
+  HeapItem *items; // the items, in heap order (items[0] has the smallest key)
+  int *position; // position[v] is the index of v in items, or NOT_IN_HEAP
+} Heap;
+
+// creates an empty heap for the vertices 0 .. capacity - 1
+Heap* heap_new(int capacity);
+// removes all the vertices from the heap
+void heap_clear(Heap *h);
+// inserts vertex v (not already in the heap) with the given key
+void heap_push(Heap *h, int v, float key);
+// removes and returns the vertex with the smallest key
+// the key is stored in *key, if not NULL
+int heap_pop(Heap *h, float *key);
+// lowers the key of vertex v, which must be in the heap
+void heap_decrease_key(Heap *h, int v, float key);
+// inserts v if not in the heap, otherwise lowers its key
+void heap_push_or_decrease(Heap *h, int v, float key);
+// changes the key of vertex v, which must be in the heap, to any value
+void heap_update_key(Heap *h, int v, float key);
+void heap_free(Heap *h);
+
+// O(1) checks, defined here so that they can be inlined
+#define heap_is_empty(h) ((h)->size == 0)
+#define heap_contains(h, v) ((h)->position[(v)] != NOT_IN_HEAP)
+// the smallest key in the heap (which must not be empty)
+#define heap_min_key(h) ((h)->items[0].key)
+// the key of vertex v, which must be in the heap
+#define heap_key(h, v) ((h)->items[(h)->position[(v)]].key)
+
+#endif
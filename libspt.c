@@ -0,0 +1,126 @@
+// The spt library: a solver reusing its buffers across the queries on a graph
+/*
+ * libspt.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "libspt.h"
+// the algorithms and their buffers
+#include "spt.h"
+// the priority queue of Dijkstra and the queue of Bellman-Ford
+#include "heap.h"
+#include "ring.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+SptWorkspace* spt_workspace_new(int order) {
+  SptWorkspace *ws = (SptWorkspace *)malloc(sizeof(SptWorkspace));
+  if(!ws) {
+    g_error("SptWorkspace can't be alloc'd");
+  }
+  ws->order = order;
+  ws->labels = (float *)malloc(order * sizeof(float));
+  ws->predecessors = (int *)malloc(order * sizeof(int));
+  if((!ws->labels || !ws->predecessors) && order > 0) {
+    g_error("SptWorkspace arrays can't be alloc'd");
+  }
+  ws->Q = heap_new(order);
+  // the buffers of Bellman-Ford are alloc'd by its first query
+  ws->ring = NULL;
+  ws->count_rm = NULL;
+  ws->mark = NULL;
+  return ws;
+}
+
+void spt_workspace_free(SptWorkspace *ws) {
+  if(ws) {
+    free(ws->labels);
+    free(ws->predecessors);
+    heap_free(ws->Q);
+    if(ws->ring) {
+      ring_free(ws->ring);
+    }
+    free(ws->count_rm);
+    free(ws->mark);
+    free(ws);
+  }
+}
+
+SptSolver* spt_solver_new(const CsrGraph *G) {
+  SptSolver *S = (SptSolver *)malloc(sizeof(SptSolver));
+  if(!S) {
+    g_error("SptSolver can't be alloc'd");
+  }
+  S->G = G;
+  // The most expensive path in the graph is |N|*max_weight
+  S->max_path = (float)(G->order) * G->max_weight + 1.0;
+  S->ws = spt_workspace_new(G->order);
+  S->labels = S->ws->labels;
+  S->predecessors = S->ws->predecessors;
+  memset(&S->stats, 0, sizeof(SptStats));
+  S->roots = g_array_new(FALSE, FALSE, sizeof(int));
+  return S;
+}
+
+// copies the roots of a query in S->roots, checking that they're vertices of the graph:
+// returns FALSE (and leaves S as it is) if they aren't
+static gboolean spt_solver_set_roots(SptSolver *S, const int *roots, int n_roots) {
+  int i;
+  if(n_roots < 1) {
+    return FALSE;
+  }
+  for(i = 0; i < n_roots; i++) {
+    if(roots[i] < 0 || roots[i] >= S->G->order) {
+      return FALSE;
+    }
+  }
+  g_array_set_size(S->roots, 0);
+  g_array_append_vals(S->roots, roots, n_roots);
+  memset(&S->stats, 0, sizeof(SptStats));
+  return TRUE;
+}
+
+int spt_solver_dijkstra(SptSolver *S, const int *roots, int n_roots) {
+  if(S->G->min_weight < 0.0) {
+    return SPT_BAD_WEIGHTS;
+  }
+  if(!spt_solver_set_roots(S, roots, n_roots)) {
+    return SPT_BAD_ROOTS;
+  }
+  return spt_s_heap(S->G, S->roots, S->max_path, S->labels, S->predecessors, S->ws->Q, &S->stats);
+}
+
+int spt_solver_bellman_ford(SptSolver *S, const int *roots, int n_roots, SptlPolicy policy) {
+  if(!spt_solver_set_roots(S, roots, n_roots)) {
+    return SPT_BAD_ROOTS;
+  }
+  return spt_l_workspace(S->G, S->roots, S->max_path, S->labels, S->predecessors,
+                         policy, S->ws, &S->stats);
+}
+
+void spt_solver_free(SptSolver *S) {
+  if(S) {
+    spt_workspace_free(S->ws);
+    g_array_free(S->roots, TRUE);
+    free(S);
+  }
+}
@@ -0,0 +1,160 @@
+// The spt library: a solver reusing its buffers across the queries on a graph (header file)
+/*
+ * libspt.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBSPT_DEFINED
+#define LIBSPT_DEFINED
+
+/*  The interface of libspt.a and libspt.so: a program builds a CsrGraph
+    (from a file with csr_graph_load, or from an array of edges with
+    csr_graph_from_edges), creates a SptSolver on it, then finds as many SPTs
+    as it needs. Every query of a solver reuses the same labels, predecessors
+    and queues, so nothing is allocated after the first one
+    csr_graph_from_edges and the solver calls report a bad input to the caller
+    (a NULL graph, a negative count of iterations) and abort only when an
+    allocation fails; csr_graph_load aborts on a bad file too
+    This header is the whole interface: the algorithms, the queues and the
+    other internals of the library are declared in its private headers
+
+      CsrGraph *G = csr_graph_from_edges(order, edges, n_edges); // NULL on a bad edge
+      SptSolver *S = spt_solver_new(G);
+      if(spt_solver_dijkstra(S, roots, n_roots) >= 0) {
+        ... S->labels[v], S->predecessors[v] ...
+      }
+      spt_solver_free(S);
+      csr_graph_free(G);
+*/
+
+#include <glib.h>
+
+#include <stddef.h>
+
+// Compressed sparse row (CSR) graph: built once, from a file or from an array of edges
+// The edges going out of vertex i are stored in dest[k] and weight[k]
+// for k in [offsets[i], offsets[i + 1]), so the adjacency list of any
+// vertex is found in O(1) and scanned sequentially
+typedef struct csr_graph_t {
+  int order; // number of vertices
+  int size; // number of edges
+  int *offsets; // order + 1 entries: offsets[order] == size
+  int *dest; // the destination of each edge
+  float *weight; // the weight of each edge
+  float min_weight; // the minimum edge weight (INFINITY if there are no edges)
+  float max_weight; // the maximum edge weight (-INFINITY if there are no edges)
+  void *mapping; // if not NULL, the arrays point into this read-only mapping of a binary file
+  size_t mapping_size;
+} CsrGraph;
+
+// A single edge, outside of any graph
+typedef struct csr_edge_t {
+  int from;
+  int to;
+  float weight;
+} CsrEdge;
+
+/*  Reads a graph in the text format of the spt program (see README.md) from
+    the file at path ("-" for standard input) directly into a CSR graph
+    Regular files are mapped in memory, anything else is read in large blocks
+    Files in the binary format are recognized by their magic number: if they're
+    regular files the returned graph uses the mapping, read-only and without copies
+    The number of bytes read is stored in *bytes_read. If trailer is not NULL,
+    the text following the graph (if any) is stored in *trailer (free with g_free)
+    A file that can't be read, or isn't a valid graph, aborts the program:
+    check it first if that's not acceptable, or use csr_graph_from_edges
+*/
+CsrGraph* csr_graph_load(const char *path, size_t *bytes_read, char **trailer);
+// builds a graph of order vertices from the n edges in the array, without
+// going through a Graph: the edges of each vertex keep the order of the array
+// returns NULL if an endpoint is not a vertex (or order or n is negative)
+CsrGraph* csr_graph_from_edges(int order, const CsrEdge *edges, int n);
+void csr_graph_free(CsrGraph *g);
+
+#define NO_LOWER_BOUND -1 // if the instance has no lower bound, the solvers return this value
+
+// The work done by a solver, to see why a graph is slow without a DEBUG build
+// The counters are kept in local variables while the solver runs and stored
+// at the end, only if the caller passed a SptStats; the times are the caller's
+typedef struct spt_stats_t {
+  gboolean counted; // TRUE if the solver filled the counters
+  guint64 relaxations; // the edges scanned
+  guint64 decreases; // the labels lowered
+  guint64 pushes; // the insertions in the queue
+  guint64 pops; // the extractions from the queue
+  guint64 reinsertions; // the insertions of vertices that had already been extracted
+  int max_queue; // the largest number of vertices in the queue at once
+  int max_pops; // the most scans of a single vertex (not counted by the parallel solvers)
+  double load_time; // the seconds spent reading the graph
+  double solve_time; // the seconds spent finding the SPT
+  double print_time; // the seconds spent printing it
+} SptStats;
+
+// The queue disciplines of the label-correcting algorithm (SPT.L)
+typedef enum sptl_policy {
+  SPTL_FIFO, // First In First Out: Bellman-Ford
+  SPTL_SLF, // Small Label First: a vertex whose label is smaller than
+            // the first one's is inserted at the front of the queue
+  SPTL_LLL, // Large Label Last: the first vertex is moved to the back while
+            // its label is greater than the average label in the queue
+  SPTL_SLF_LLL, // both of the above
+  SPTL_PAPE, // D'Esopo-Pape: a vertex that has already been in the queue
+             // is inserted at the front, otherwise at the back
+  SPTL_N_POLICIES
+} SptlPolicy;
+
+// the buffers of a solver (see spt.h)
+struct spt_workspace_t;
+
+// A solver bound to a graph: a solver must be used by one thread at a time,
+// but many solvers can share the same graph
+typedef struct spt_solver_t {
+  const CsrGraph *G; // the graph, which must outlive the solver
+  float max_path; // the label of the vertices not reached (order * max_weight + 1)
+  // the SPT found by the last query, valid until the next one:
+  // the roots are their own predecessors, the vertices not reached have
+  // label max_path and the first root as predecessor
+  float *labels;
+  int *predecessors;
+  SptStats stats; // the counters of the last query
+  struct spt_workspace_t *ws; // the buffers shared by the queries
+  GArray *roots; // the roots of the last query
+} SptSolver;
+
+// returned by the queries if n_roots < 1 or a root is not a vertex of the graph
+// (then the SPT of the last query is left as it is)
+#define SPT_BAD_ROOTS -2
+// returned by spt_solver_dijkstra if an edge weight is negative, where
+// Dijkstra's labels would be wrong (spt_solver_bellman_ford finds the SPT)
+#define SPT_BAD_WEIGHTS -3
+
+SptSolver* spt_solver_new(const CsrGraph *G);
+/*  Finds the SPT of the graph rooted in the n_roots vertices in roots with
+    Dijkstra's algorithm: the edge weights must not be negative
+    Returns the number of iterations, SPT_BAD_ROOTS or SPT_BAD_WEIGHTS
+*/
+int spt_solver_dijkstra(SptSolver *S, const int *roots, int n_roots);
+/*  Finds the SPT with Bellman-Ford, using the given queue discipline:
+    any edge weights are allowed. Returns the number of iterations,
+    NO_LOWER_BOUND if a negative cycle is reachable from the roots, or
+    SPT_BAD_ROOTS
+*/
+int spt_solver_bellman_ford(SptSolver *S, const int *roots, int n_roots, SptlPolicy policy);
+void spt_solver_free(SptSolver *S);
+
+#endif
@@ -25,128 +25,917 @@
 #include "glib-graph.h"
 // the header declaring the functions that implement the algorithms
 #include "spt.h"
+// the solver reusing its buffers across the queries
+#include "libspt.h"
+// the trace of the relaxations
+#include "trace.h"
+// the parallel batches of queries
+#include "batch.h"
+// the point-to-point queries
+#include "p2p.h"
+// the buffered output of the SPTs
+#include "output.h"
 
-#include <readline/readline.h> // for reading input lines
 #include <glib.h> // Glib header for data structures (GList, GQueue, ...)
 
 // standard library headers
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h> // for getopt
 
 // define an array of function pointers to choose the algorithm to run on G at runtime
-#define N_IMPLEMENTED 2
-int (*algorithms[N_IMPLEMENTED])(Graph *, GArray *, float, float *, int *) = {
-  spt_s, spt_l // spt.s has index 0, spt.l has index 1
+#define N_IMPLEMENTED 6
+int (*algorithms[N_IMPLEMENTED])(const CsrGraph *, GArray *, float, float *, int *) = {
+  spt_s, spt_l, // spt.s has index 0, spt.l has index 1
+  spt_s_dial, spt_s_radix, // spt.s with a bucket queue or a radix heap
+  spt_ds, spt_lp // parallel delta-stepping and Bellman-Ford
 };
+char *algorithm_names[N_IMPLEMENTED] = {
+  "Dijkstra", "Bellman-Ford", "Dijkstra (Dial)", "Dijkstra (radix heap)", "Delta-stepping",
+  "Bellman-Ford (parallel)"
+};
+// the index of spt.l in algorithms[]
+#define SPT_L 1
+// the index of spt.s in algorithms[] with each kind of priority queue
+#define SPT_S_HEAP 0
+#define SPT_S_DIAL 2
+#define SPT_S_RADIX 3
+// the index of the parallel algorithms in algorithms[]
+#define SPT_DS 4
+#define SPT_LP 5
+// the number of landmarks of ALT if not given with -k
+#define DEFAULT_LANDMARKS 16
+
+// Chooses the priority queue of Dijkstra's algorithm from the bounds on the weights:
+// the Dial queue if its buckets are few enough, otherwise the radix heap.
+// Both need non-negative weights, so in any other case the d-ary heap is kept
+long int choose_spt_s_queue(float min_w, float max_w) {
+  if(min_w > 0 && max_w / min_w <= DIAL_MAX_BUCKETS) {
+    return SPT_S_DIAL;
+  }
+  if(min_w >= 0) {
+    return SPT_S_RADIX;
+  }
+  return SPT_S_HEAP;
+}
+
+// Parses the name or the index of an algorithm: returns its index in algorithms[],
+// -1 for the automatic choice or -2 if it's not valid
+long int parse_algorithm(const char *name) {
+  char *end;
+  long int choice = strtol(name, &end, 10);
+  if(end != name && *end == '\0') {
+    return (choice >= 0 && choice < N_IMPLEMENTED ? choice : -2);
+  }
+  if(g_ascii_strcasecmp(name, "auto") == 0) {
+    return -1;
+  }
+  if(g_ascii_strcasecmp(name, "dijkstra") == 0) {
+    return SPT_S_HEAP;
+  }
+  if(g_ascii_strcasecmp(name, "bellman-ford") == 0) {
+    return SPT_L;
+  }
+  if(g_ascii_strcasecmp(name, "dial") == 0) {
+    return SPT_S_DIAL;
+  }
+  if(g_ascii_strcasecmp(name, "radix") == 0) {
+    return SPT_S_RADIX;
+  }
+  if(g_ascii_strcasecmp(name, "delta-stepping") == 0 || g_ascii_strcasecmp(name, "ds") == 0) {
+    return SPT_DS;
+  }
+  if(g_ascii_strcasecmp(name, "parallel-bellman-ford") == 0 || g_ascii_strcasecmp(name, "pbf") == 0) {
+    return SPT_LP;
+  }
+  return -2;
+}
+
+// Parses a list of roots separated by blanks or commas, storing the valid ones in roots
+// Returns the number of roots found
+int parse_roots(const char *line, int order, GArray *roots) {
+  int root;
+  char *end;
+  g_array_set_size(roots, 0);
+  while(*line != '\0') {
+    // skips separators
+    if(*line == ' ' || *line == ',' || *line == '\t' || *line == '\n' || *line == '\r') {
+      line++;
+      continue;
+    }
+    root = (int)strtol(line, &end, 10);
+    if(end == line) {
+      g_warning("Unexpected \"%c\" in the rootlist", *line);
+      line++;
+      continue;
+    }
+    line = end;
+    if(root >= 0 && root < order) {
+      // appends root and returns the new array:
+      roots = g_array_append_val(roots, root);
+    }
+    else {
+      g_warning("The root %d in the rootlist is not a valid vertex", root);
+    }
+  }
+  return roots->len;
+}
+
+void usage(char *progname) {
+  fprintf(stderr, "Usage: %s [-f graph] [-r roots | -b batch] [-j threads] [-a algorithm] [-o text|csv|binary|cost] [-x vertices] [-t targets] [-u vertices] [-m spt|p2p] [-w binary graph]\n"
+                  "\t[-q auto|heap|dial|radix] [-p fifo|slf|lll|slf+lll|pape] [-c] [-d delta] [-k landmarks] [-l file] [-s] [-v]\n", progname);
+  fprintf(stderr, "\t-f: read the graph from this file (mapped in memory), \"-\" is standard input (default)\n");
+  fprintf(stderr, "\t   the file can be in the text format or in the binary format written by -w\n");
+  fprintf(stderr, "\t-r: the roots of the SPT, separated by blanks or commas\n");
+  fprintf(stderr, "\t-b: read one list of roots per line from this file and find the SPT of each\n");
+  fprintf(stderr, "\t   (the graph is read once)\n");
+  fprintf(stderr, "\t-j: answer the queries of the batch on this many threads (default: 1)\n");
+  fprintf(stderr, "\t   the parallel algorithms run each query on this many threads instead (default: all the processors)\n");
+  fprintf(stderr, "\t   without -r and -b, the roots (and the algorithm, without -a) are read\n");
+  fprintf(stderr, "\t   from the lines after the graph\n");
+  fprintf(stderr, "\t-a: auto, dijkstra, bellman-ford, dial, radix, delta-stepping (or ds),\n");
+  fprintf(stderr, "\t   parallel-bellman-ford (or pbf)\n");
+  fprintf(stderr, "\t   or the algorithm's index (default: auto)\n");
+  fprintf(stderr, "\t   auto is Dijkstra if all the weights are non-negative, otherwise Bellman-Ford\n");
+  fprintf(stderr, "\t-o: print the whole SPT (text), as CSV (csv), as the raw arrays (binary)\n");
+  fprintf(stderr, "\t   or just its cost (cost) (default: text)\n");
+  fprintf(stderr, "\t-x: print only these vertices of the SPT, separated by blanks or commas\n");
+  fprintf(stderr, "\t-t: print the path from the roots to each of these vertices instead of the SPT\n");
+  fprintf(stderr, "\t-u: print the subtree of each of these vertices (for a root, all the vertices it serves)\n");
+  fprintf(stderr, "\t-m: find SPTs (spt) or point-to-point shortest paths (p2p) (default: spt)\n");
+  fprintf(stderr, "\t   with p2p, -r and each line of -b are a source and a target,\n");
+  fprintf(stderr, "\t   -a is bidijkstra (default), dijkstra, alt (A* with landmarks)\n");
+  fprintf(stderr, "\t   or ch (contraction hierarchies)\n");
+  fprintf(stderr, "\t-w: write the graph to this file in the binary format, then exit\n");
+  fprintf(stderr, "\t-q: the priority queue used by Dijkstra (default: auto)\n");
+  fprintf(stderr, "\t   dial falls back to radix if it would need more than %d buckets\n", DIAL_MAX_BUCKETS);
+  fprintf(stderr, "\t-p: the queue discipline used by Bellman-Ford (default: fifo)\n");
+  fprintf(stderr, "\t-c: Bellman-Ford stops as soon as a negative cycle appears and prints it\n");
+  fprintf(stderr, "\t-d: the width of the buckets of delta-stepping (default: from the weights)\n");
+  fprintf(stderr, "\t-k: the number of landmarks of alt (default: %d)\n", DEFAULT_LANDMARKS);
+  fprintf(stderr, "\t-l: read the landmarks of alt from this file, or write them to it if it\n");
+  fprintf(stderr, "\t   doesn't hold the landmarks of the graph\n");
+  fprintf(stderr, "\t-s: print the counters and the times of each query as JSON on standard error\n");
+  fprintf(stderr, "\t-v: print every edge that violates Bellman's condition (the default in the debug build)\n");
+}
 
-void print_spt(char *algorithm, GArray *roots, float *labels, int *predecessors, const int iterations, const int graph_order) {
+// Prints the SPT in the text format: a header, the label and predecessor of the
+// vertices (all of them if vertices is NULL), then the cost of the whole SPT
+void print_spt(Output *out, char *algorithm, GArray *roots, const float *labels, const int *predecessors,
+               const int iterations, const int graph_order, GArray *vertices) {
   // the resulting spt is represented by labels & predecessors
   float spt_cost = 0.0;
+  char cost[64];
   int i;
-  printf("After %d iterations, the SPT with root(s) [ ", iterations);
+  output_string(out, "After ");
+  output_int(out, iterations);
+  output_string(out, " iterations, the SPT with root(s) [ ");
   for(i = 0; i < roots->len - 1; i++) {
-    printf("%d, ", g_array_index(roots, int, i));
+    output_int(out, g_array_index(roots, int, i));
+    output_string(out, ", ");
   }
-  printf("%d ] found by %s is:\n", g_array_index(roots, int, roots->len - 1), algorithm);
+  output_int(out, g_array_index(roots, int, roots->len - 1));
+  output_string(out, " ] found by ");
+  output_string(out, algorithm);
+  output_string(out, " is:\n");
+  output_spt(out, OUTPUT_TEXT, labels, predecessors, graph_order, vertices, iterations);
   for (i = 0; i < graph_order; i++) {
-    printf("label[%d] = %.3f\tpred[%d] = %d\n", i, labels[i], i, predecessors[i]);
     spt_cost += labels[i]; // computes the SPT's cost: the sum of all the labels
   }
-  printf("Total cost of the SPT: %f\n", spt_cost);
+  snprintf(cost, sizeof(cost), "Total cost of the SPT: %f\n", spt_cost);
+  output_string(out, cost);
 }
 
-// Main function
-
-int main() {
-  float max_w, min_w;
-  // reads the graph using the library glib-graph
-  Graph *graph = new_graph(&min_w, &max_w);
-  // stores in max_w and min_w the maximum and minimum weights of edges in the graph
+// The options that apply to every query on the same graph
+typedef struct spt_options_t {
+  long int algorithm; // the index in algorithms[] (-1 for the automatic choice)
+  long int spt_s_queue; // the priority queue used by Dijkstra (-1 for the automatic choice)
+  SptlPolicy spt_l_queue; // the queue discipline used by Bellman-Ford
+  gboolean find_cycle; // Bellman-Ford detects negative cycles with subtree disassembly
+  OutputFormat format; // the format of the SPTs
+  GArray *vertices; // the vertices printed (NULL for all of them)
+  GArray *targets; // the vertices whose paths are printed instead of the SPT (if not NULL)
+  GArray *subtrees; // the vertices whose subtrees are printed instead of the SPT (if not NULL)
+  float delta; // the width of the buckets of delta-stepping (0 for the default)
+  Team *team; // the threads running the parallel algorithms
+  gboolean stats; // the stats of each query are printed as JSON
+  double load_time; // the seconds spent reading the graph, reported with the stats
+} SptOptions;
 
-  // The most expensive path in the graph is |N|*max_weight
-  // Adding 1.0 to that gives the value used as a fake edge weigth for the initial tree
-  float max_path = (float)(graph->order) * max_w + 1.0;
-
-#ifdef DEBUG // the graph is printed to stdout
-  puts("GRAPH");
-  print_graph(stdout, *graph);
-#endif
-
-  // Read the root nodes: this can be a list of any vertices in the graph
-  int root;
-  char *token, *line;
-  // The data structure that stores the root list is a GArray
-  GArray *spt_rootlist = g_array_new(FALSE, FALSE, sizeof(int));
+// Returns the index in algorithms[] of the algorithm chosen by opts for csr
+long int resolve_algorithm(const CsrGraph *csr, const SptOptions *opts) {
+  long int choice = opts->algorithm;
+  if(choice == -1) {
+    // Dijkstra is correct only without negative edges
+    choice = (csr->min_weight >= 0 ? SPT_S_HEAP : SPT_L);
+  }
+  // Dijkstra's queue is the one chosen with -q, or it's picked from the weights
+  if (choice == SPT_S_HEAP) {
+    choice = (opts->spt_s_queue == -1 ? choose_spt_s_queue(csr->min_weight, csr->max_weight) : opts->spt_s_queue);
+  }
+  // a Dial queue forced with -q or -a can't have one bucket per weight unit
+  // if the weights span too wide a range: the radix heap is used instead
+  if(choice == SPT_S_DIAL && csr->min_weight > 0 && !(csr->max_weight / csr->min_weight <= DIAL_MAX_BUCKETS)) {
+    static gboolean warned = FALSE;
+    if(!warned) {
+      g_warning("The Dial queue would need more than %d buckets: using the radix heap", DIAL_MAX_BUCKETS);
+      warned = TRUE;
+    }
+    choice = SPT_S_RADIX;
+  }
+  return choice;
+}
 
-  line = readline("Set the root(s): ");
-  // tokenizes the input line to get the vertices
-  token = strtok(line, " ");
-  while(token != NULL) {
-    root = atoi(token); // assumes that it's an integer
-    if(root >= 0 && root < graph->order) {
-      // appends root and returns the new array:
-      spt_rootlist = g_array_append_val(spt_rootlist, root);
+// Prints the result of a query as chosen by opts
+void print_result(const CsrGraph *csr, GArray *roots, const SptOptions *opts, char *algorithm,
+                  int iterations, const float *spt_labels, const int *spt_pred, GArray *neg_cycle) {
+  if(iterations == NO_LOWER_BOUND && opts->format != OUTPUT_BINARY) {
+      puts("Negative cycle! No lower bound.");
+      if(neg_cycle && neg_cycle->len > 0) {
+        printf("Cycle: ");
+        for(int i = 0; i < neg_cycle->len; i++) {
+          printf("%d -> ", g_array_index(neg_cycle, int, i));
+        }
+        printf("%d\n", g_array_index(neg_cycle, int, 0));
+      }
+  }
+  else if(opts->format == OUTPUT_COST) {
+    float spt_cost = 0.0;
+    for(int i = 0; i < csr->order; i++) {
+      spt_cost += spt_labels[i];
+    }
+    printf("%f\n", spt_cost);
+  }
+  else {
+    // the SPT goes through a large buffer: it's written in order with the
+    // rest of standard output when the buffer is freed
+    Output *out = output_new(stdout);
+    if(opts->format == OUTPUT_TEXT) {
+      print_spt(out, algorithm, roots, spt_labels, spt_pred, iterations, csr->order, opts->vertices);
     }
     else {
-      g_warning("The root %d in the rootlist is not a valid vertex", root);
+      output_spt(out, opts->format, spt_labels, spt_pred, csr->order, opts->vertices, iterations);
     }
+    output_free(out);
+  }
+}
+
+// Prints the stats of a query as a JSON object on a single line
+void print_stats(FILE *out, const CsrGraph *csr, const char *algorithm, int iterations, const SptStats *stats) {
+  fprintf(out, "{\"algorithm\": \"%s\", \"vertices\": %d, \"edges\": %d, \"iterations\": %d, "
+          "\"negative_cycle\": %s, ", algorithm, csr->order, csr->size, iterations,
+          iterations == NO_LOWER_BOUND ? "true" : "false");
+  if(stats->counted) {
+    fprintf(out, "\"relaxations\": %" G_GUINT64_FORMAT ", \"decreases\": %" G_GUINT64_FORMAT ", "
+            "\"pushes\": %" G_GUINT64_FORMAT ", \"pops\": %" G_GUINT64_FORMAT ", "
+            "\"reinsertions\": %" G_GUINT64_FORMAT ", \"max_queue\": %d, \"max_pops\": %d, ",
+            stats->relaxations, stats->decreases, stats->pushes, stats->pops,
+            stats->reinsertions, stats->max_queue, stats->max_pops);
+  }
+  fprintf(out, "\"load_s\": %.6f, \"solve_s\": %.6f, \"print_s\": %.6f}\n",
+          stats->load_time, stats->solve_time, stats->print_time);
+}
 
-    token = strtok(NULL, " ");
+// Prints the paths to opts->targets and the subtrees of opts->subtrees in the
+// SPT: its index is built once, then each path costs as much as its length
+void print_tree_queries(const CsrGraph *csr, const SptOptions *opts, float max_path,
+                        const float *spt_labels, const int *spt_pred) {
+  SptTree *T = spt_tree_new(csr->order, spt_labels, spt_pred, max_path);
+  Output *out = output_new(stdout);
+  GArray *path = g_array_new(FALSE, FALSE, sizeof(int));
+  const int *subtree;
+  int i, k, v, edges, size;
+  for(i = 0; opts->targets && i < opts->targets->len; i++) {
+    v = g_array_index(opts->targets, int, i);
+    edges = spt_tree_path(T, v, path);
+    if(edges == -1) {
+      output_string(out, "No path to ");
+      output_int(out, v);
+      output_char(out, '\n');
+      continue;
+    }
+    output_string(out, "Path to ");
+    output_int(out, v);
+    output_string(out, " (cost ");
+    output_float3(out, spt_labels[v]);
+    output_string(out, ", ");
+    output_int(out, edges);
+    output_string(out, " edges): ");
+    for(k = 0; k < path->len; k++) {
+      output_int(out, g_array_index(path, int, k));
+      output_string(out, (k < path->len - 1 ? " -> " : "\n"));
+    }
   }
-  free(line);
-  line = token = NULL;
+  for(i = 0; opts->subtrees && i < opts->subtrees->len; i++) {
+    v = g_array_index(opts->subtrees, int, i);
+    subtree = spt_tree_subtree(T, v, &size);
+    output_string(out, "Subtree of ");
+    output_int(out, v);
+    output_string(out, " (");
+    output_int(out, size);
+    output_string(out, " vertices):");
+    for(k = 0; k < size; k++) {
+      output_char(out, ' ');
+      output_int(out, subtree[k]);
+    }
+    output_char(out, '\n');
+  }
+  g_array_free(path, TRUE);
+  output_free(out);
+  spt_tree_free(T);
+}
+
+// Finds and prints the SPT of the solver's graph with the given roots: Dijkstra
+// and Bellman-Ford run on the solver, the other algorithms on its arrays
+void run_query(SptSolver *solver, GArray *roots, const SptOptions *opts, GArray *neg_cycle) {
+  const CsrGraph *csr = solver->G;
+  float max_path = solver->max_path;
+  float *spt_labels = solver->labels;
+  int *spt_pred = solver->predecessors;
 
 #ifdef DEBUG // print the spt_rootlist
   g_print("ROOTLIST: [");
-  for(int i = 0; i < spt_rootlist->len; i++) {
-    g_print("%d, ", g_array_index(spt_rootlist, int, i));
+  for(int i = 0; i < roots->len; i++) {
+    g_print("%d, ", g_array_index(roots, int, i));
   }
   g_print("]\n");
 #endif
 
-  int num_labels = graph->order;
-  if(spt_rootlist->len > 1) {
-    // since a new hyper-root will be added, the number of labels must be one more
-    num_labels++;
+  long int choice = resolve_algorithm(csr, opts);
+  char *chosen_algo = algorithm_names[choice];
+  if(opts->format == OUTPUT_TEXT) {
+    g_print("Run %s...\n", chosen_algo);
+  }
+  int iterations;
+  char *policy_algo = NULL; // the name of Bellman-Ford with its queue discipline
+  g_array_set_size(neg_cycle, 0);
+  // the counters are filled by the solvers
+  SptStats stats;
+  memset(&stats, 0, sizeof(SptStats));
+  SptStats *st = (opts->stats ? &stats : NULL);
+  GTimer *timer = (st ? g_timer_new() : NULL);
+  if(choice == SPT_L && opts->find_cycle) {
+    // Bellman-Ford with subtree disassembly (FIFO queue)
+    chosen_algo = "Bellman-Ford (subtree disassembly)";
+    iterations = spt_l_tarjan(csr, roots, max_path, spt_labels, spt_pred, neg_cycle, st);
+  }
+  else if(choice == SPT_L) {
+    // Bellman-Ford with the queue discipline chosen with -p
+    if(opts->spt_l_queue != SPTL_FIFO) {
+      chosen_algo = policy_algo = g_strdup_printf("%s (%s)", chosen_algo, sptl_policy_names[opts->spt_l_queue]);
+    }
+    iterations = spt_solver_bellman_ford(solver, (int *)roots->data, roots->len, opts->spt_l_queue);
+    stats = solver->stats;
+  }
+  else if(choice == SPT_S_HEAP) {
+    if(csr->min_weight < 0) {
+      // the library refuses negative weights, but -a dijkstra still runs
+      // (with labels that may be wrong) on the solver's arrays
+      iterations = spt_s_heap(csr, roots, max_path, spt_labels, spt_pred, solver->ws->Q, st);
+    }
+    else {
+      iterations = spt_solver_dijkstra(solver, (int *)roots->data, roots->len);
+      stats = solver->stats;
+    }
+  }
+  else if(choice == SPT_DS) {
+    // delta-stepping on the threads started once for all the queries
+    iterations = spt_ds_team(csr, roots, max_path, spt_labels, spt_pred, opts->delta, opts->team, st);
+  }
+  else if(choice == SPT_LP) {
+    iterations = spt_lp_team(csr, roots, max_path, spt_labels, spt_pred, opts->team, st);
+  }
+  else {
+    // Dijkstra with the Dial queue or the radix heap
+    iterations = spt_s_monotone(csr, roots, max_path, spt_labels, spt_pred,
+                                (choice == SPT_S_DIAL ? DIAL_QUEUE : RADIX_HEAP), st);
   }
 
-  // each node has a label: the cost of the shortest path from root to i
-  float *spt_labels = (float *)malloc(num_labels * sizeof(float));
-  // a node j has a predecessor i in the SPT <=> in the SPT there is an edge i -> j
-  int *spt_pred = (int *)malloc(num_labels * sizeof(int));
+  if(st) {
+    stats.solve_time = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+  }
+
+  // Print the resulting SPT (or the paths and subtrees asked for)
+  if((opts->targets || opts->subtrees) && iterations != NO_LOWER_BOUND) {
+    print_tree_queries(csr, opts, max_path, spt_labels, spt_pred);
+  }
+  else {
+    print_result(csr, roots, opts, chosen_algo, iterations, spt_labels, spt_pred, neg_cycle);
+  }
+  if(st) {
+    fflush(stdout);
+    stats.print_time = g_timer_elapsed(timer, NULL);
+    stats.load_time = opts->load_time;
+    print_stats(stderr, csr, chosen_algo, iterations, &stats);
+    g_timer_destroy(timer);
+  }
+  g_free(policy_algo);
+}
+
+// The state of the output of a parallel batch: the results are printed
+// in the order of the queries, each thread waiting for its turn
+typedef struct batch_output_t {
+  const CsrGraph *csr;
+  const SptOptions *opts;
+  char *algorithm;
+  int next; // the next query to be printed
+  GMutex lock;
+  GCond turn;
+} BatchOutput;
+
+// SptResultFunc printing the results of a parallel batch
+void print_batch_result(int query, GArray *roots, const float *labels,
+                        const int *predecessors, int iterations, gpointer data) {
+  BatchOutput *out = data;
+  g_mutex_lock(&out->lock);
+  while(out->next != query) {
+    g_cond_wait(&out->turn, &out->lock);
+  }
+  if(out->opts->format == OUTPUT_TEXT) {
+    g_print("Run %s...\n", out->algorithm);
+  }
+  print_result(out->csr, roots, out->opts, out->algorithm, iterations, labels, predecessors, NULL);
+  out->next++;
+  g_cond_broadcast(&out->turn);
+  g_mutex_unlock(&out->lock);
+}
+
+// Runs all the queries of a batch on n_threads threads with spt_batch
+void run_parallel_batch(const CsrGraph *csr, GPtrArray *queries, const SptOptions *opts, int n_threads) {
+  long int choice = resolve_algorithm(csr, opts);
+  BatchOutput out = {csr, opts, algorithm_names[choice], 0};
+  g_mutex_init(&out.lock);
+  g_cond_init(&out.turn);
+  // Dijkstra with the binary heap reuses the one in each thread's workspace
+  spt_batch(csr, queries, (choice == SPT_S_HEAP ? NULL : algorithms[choice]), n_threads,
+            NULL, NULL, NULL, print_batch_result, &out);
+  g_mutex_clear(&out.lock);
+  g_cond_clear(&out.turn);
+}
+
+// the algorithms of the point-to-point queries
+#define N_P2P_METHODS 4
+char *p2p_method_names[N_P2P_METHODS] = {"bidijkstra", "dijkstra", "alt", "ch"};
+#define P2P_BIDIJKSTRA 0
+#define P2P_DIJKSTRA 1
+#define P2P_ALT 2
+#define P2P_CH 3
+
+// The state of the point-to-point queries, built once for all of them
+typedef struct p2p_state_t {
+  int method; // the index in p2p_method_names
+  const CsrGraph *csr;
+  CsrGraph *reverse; // the reverse of csr
+  P2pWorkspace *ws;
+  Landmarks *landmarks; // only for ALT
+  ChGraph *hierarchy; // only for contraction hierarchies
+  GArray *ends; // the source and target of the query
+  GArray *path;
+} P2pState;
+
+// Answers the point-to-point query in line ("source target") and prints
+// the path with its cost (or just the cost)
+void run_p2p_query(P2pState *st, const char *line, gboolean cost_only) {
+  if(parse_roots(line, st->csr->order, st->ends) != 2) {
+    g_warning("A point-to-point query needs a source and a target");
+    return;
+  }
+  int source = g_array_index(st->ends, int, 0);
+  int target = g_array_index(st->ends, int, 1);
+  int settled = 0;
+  float cost;
+  switch(st->method) {
+  case P2P_DIJKSTRA:
+    cost = p2p_alt(st->csr, NULL, st->ws, source, target, st->path, &settled);
+    break;
+  case P2P_ALT:
+    cost = p2p_alt(st->csr, st->landmarks, st->ws, source, target, st->path, &settled);
+    break;
+  case P2P_CH:
+    cost = p2p_ch(st->hierarchy, st->ws, source, target, st->path, &settled);
+    break;
+  default:
+    cost = p2p_bidijkstra(st->csr, st->reverse, st->ws, source, target, st->path, &settled);
+  }
+
+  if(cost_only) {
+    printf("%f\n", cost);
+  }
+  else if(isinf(cost)) {
+    printf("No path from %d to %d\n", source, target);
+  }
+  else {
+    printf("Path from %d to %d found by %s (cost %f, %d vertices settled): ",
+           source, target, p2p_method_names[st->method], cost, settled);
+    for(int i = 0; i < st->path->len - 1; i++) {
+      printf("%d -> ", g_array_index(st->path, int, i));
+    }
+    printf("%d\n", g_array_index(st->path, int, st->path->len - 1));
+  }
+}
+
+// Returns the k landmarks of ALT: if path is not NULL they're read from that
+// file, or chosen and written to it if it doesn't hold the landmarks of csr
+Landmarks* prepare_landmarks(const CsrGraph *csr, const CsrGraph *reverse, int k, const char *path) {
+  Landmarks *lm = (path ? landmarks_load(path, csr) : NULL);
+  if(lm) {
+    g_message("Read %d landmarks from %s", lm->k, path);
+    return lm;
+  }
+  GTimer *timer = g_timer_new();
+  lm = landmarks_new(csr, reverse, k);
+  g_message("Chose %d landmarks in %.3f s", lm->k, g_timer_elapsed(timer, NULL));
+  g_timer_destroy(timer);
+  if(path) {
+    landmarks_save(lm, path);
+  }
+  return lm;
+}
+
+// Main function
+
+int main(int argc, char **argv) {
+  SptOptions opts = {-1, -1, SPTL_FIFO, FALSE, OUTPUT_TEXT, NULL, NULL, NULL, 0.0, NULL, FALSE, 0.0};
+  // the algorithm is read after the graph if not given with -a
+  gboolean algorithm_set = FALSE;
+  // point-to-point queries instead of SPTs
+  gboolean p2p = FALSE;
+  // the algorithm given with -a (if any)
+  char *algorithm_arg = NULL;
+  // the file the graph is read from ("-" for standard input)
+  char *graph_file = "-";
+  // the file the graph is saved to in the binary format (if any)
+  char *binary_file = NULL;
+  // the roots given with -r and the file of root lists given with -b (if any)
+  char *roots_arg = NULL;
+  char *batch_file = NULL;
+  // the number of threads answering the queries of the batch
+  int n_threads = 1;
+  gboolean threads_set = FALSE;
+  // the number of landmarks of ALT and the file they're kept in (if any)
+  int n_landmarks = DEFAULT_LANDMARKS;
+  char *landmarks_file = NULL;
+  // the vertices printed, given with -x (if any)
+  char *vertices_arg = NULL;
+  // the targets of the paths (-t) and the vertices of the subtrees (-u) printed
+  char *targets_arg = NULL;
+  char *subtrees_arg = NULL;
+#ifdef DEBUG // the relaxations are traced on stdout
+  trace_set_sink(trace_print, stdout);
+#endif
+  int opt, p;
+  while((opt = getopt(argc, argv, "f:r:b:j:a:o:x:t:u:m:w:q:p:cd:k:l:sv")) != -1) {
+    switch(opt) {
+    case 'f':
+      graph_file = optarg;
+      break;
+    case 'r':
+      roots_arg = optarg;
+      break;
+    case 'b':
+      batch_file = optarg;
+      break;
+    case 'j':
+      n_threads = atoi(optarg);
+      if(n_threads < 1) {
+        usage(argv[0]);
+        return 1;
+      }
+      threads_set = TRUE;
+      break;
+    case 'd':
+      opts.delta = atof(optarg);
+      if(!(opts.delta > 0.0)) {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'k':
+      n_landmarks = atoi(optarg);
+      if(n_landmarks < 1) {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'l':
+      landmarks_file = optarg;
+      break;
+    case 'a':
+      algorithm_arg = optarg;
+      break;
+    case 'm':
+      if(strcmp(optarg, "spt") == 0 || strcmp(optarg, "p2p") == 0) {
+        p2p = (strcmp(optarg, "p2p") == 0);
+      }
+      else {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'o':
+      for(p = 0; p < OUTPUT_N_FORMATS && strcmp(optarg, output_format_names[p]) != 0; p++)
+        ;
+      if(p == OUTPUT_N_FORMATS) {
+        usage(argv[0]);
+        return 1;
+      }
+      opts.format = p;
+      break;
+    case 'x':
+      vertices_arg = optarg;
+      break;
+    case 't':
+      targets_arg = optarg;
+      break;
+    case 'u':
+      subtrees_arg = optarg;
+      break;
+    case 'w':
+      binary_file = optarg;
+      break;
+    case 'q':
+      if(strcmp(optarg, "auto") == 0) {
+        opts.spt_s_queue = -1;
+      }
+      else if(strcmp(optarg, "heap") == 0) {
+        opts.spt_s_queue = SPT_S_HEAP;
+      }
+      else if(strcmp(optarg, "dial") == 0) {
+        opts.spt_s_queue = SPT_S_DIAL;
+      }
+      else if(strcmp(optarg, "radix") == 0) {
+        opts.spt_s_queue = SPT_S_RADIX;
+      }
+      else {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'p':
+      for(p = 0; p < SPTL_N_POLICIES && g_ascii_strcasecmp(optarg, sptl_policy_names[p]) != 0; p++)
+        ;
+      if(p == SPTL_N_POLICIES) {
+        usage(argv[0]);
+        return 1;
+      }
+      opts.spt_l_queue = p;
+      break;
+    case 'c':
+      opts.find_cycle = TRUE;
+      break;
+    case 's':
+      opts.stats = TRUE;
+      break;
+    case 'v':
+      trace_set_sink(trace_print, stdout);
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if(roots_arg && batch_file) {
+    usage(argv[0]);
+    return 1;
+  }
+  // the point-to-point queries print a path, not an SPT
+  if(p2p && (opts.format == OUTPUT_CSV || opts.format == OUTPUT_BINARY || vertices_arg
+             || targets_arg || subtrees_arg)) {
+    usage(argv[0]);
+    return 1;
+  }
+  // the paths and subtrees are printed as text
+  if((targets_arg || subtrees_arg) && (opts.format != OUTPUT_TEXT || vertices_arg)) {
+    usage(argv[0]);
+    return 1;
+  }
+  // the names of the algorithms depend on the kind of query
+  int p2p_method = P2P_BIDIJKSTRA;
+  if(algorithm_arg && p2p) {
+    for(p2p_method = 0; p2p_method < N_P2P_METHODS
+        && g_ascii_strcasecmp(algorithm_arg, p2p_method_names[p2p_method]) != 0; p2p_method++)
+      ;
+    if(g_ascii_strcasecmp(algorithm_arg, "auto") == 0) {
+      p2p_method = P2P_BIDIJKSTRA;
+    }
+    else if(p2p_method == N_P2P_METHODS) {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  else if(algorithm_arg) {
+    opts.algorithm = parse_algorithm(algorithm_arg);
+    if(opts.algorithm == -2) {
+      usage(argv[0]);
+      return 1;
+    }
+    algorithm_set = TRUE;
+  }
+
+  // the file is parsed directly into the CSR representation
+  // the lines after the graph (if any) are kept in trailer
+  size_t bytes;
+  char *trailer = NULL;
+  GTimer *timer = g_timer_new();
+  CsrGraph *csr = csr_graph_load(graph_file, &bytes, &trailer);
+  double elapsed = g_timer_elapsed(timer, NULL);
+  g_timer_destroy(timer);
+  opts.load_time = elapsed;
+  g_message("Read %d vertices and %d edges: %.1f MB in %.3f s (%.1f MB/s)",
+            csr->order, csr->size, bytes / 1e6, elapsed, bytes / 1e6 / elapsed);
+
+#ifdef DEBUG // the graph is printed to stdout
+  puts("GRAPH");
+  print_csr_graph(stdout, csr);
+#endif
+
+  if(binary_file) {
+    // the graph is just converted to the binary format
+    csr_graph_save(csr, binary_file);
+    csr_graph_free(csr);
+    g_free(trailer);
+    return 0;
+  }
+
+  if(p2p) {
+    // the reverse graph is built once for all the queries
+    P2pState st = {p2p_method, csr, csr_graph_reverse(csr), p2p_workspace_new(csr->order), NULL, NULL,
+                   g_array_new(FALSE, FALSE, sizeof(int)), g_array_new(FALSE, FALSE, sizeof(int))};
+    if(p2p_method == P2P_ALT) {
+      st.landmarks = prepare_landmarks(csr, st.reverse, n_landmarks, landmarks_file);
+    }
+    else if(p2p_method == P2P_CH) {
+      GTimer *ch_timer = g_timer_new();
+      st.hierarchy = ch_graph_new(csr);
+      g_message("Contracted %d vertices in %.3f s, adding %d shortcuts",
+                csr->order, g_timer_elapsed(ch_timer, NULL), st.hierarchy->shortcuts);
+      g_timer_destroy(ch_timer);
+    }
+    if(batch_file) {
+      // every line of the batch file is a source and a target
+      FILE *batch = fopen(batch_file, "r");
+      if(!batch) {
+        g_error("Can't open %s", batch_file);
+      }
+      char *line = NULL;
+      size_t line_size = 0;
+      while(getline(&line, &line_size, batch) != -1) {
+        run_p2p_query(&st, line, opts.format == OUTPUT_COST);
+      }
+      free(line);
+      fclose(batch);
+    }
+    else {
+      // the query is given with -r, or on the line after the graph
+      char **lines = g_strsplit(trailer ? trailer : "", "\n", 2);
+      run_p2p_query(&st, roots_arg ? roots_arg : (lines[0] ? lines[0] : ""), opts.format == OUTPUT_COST);
+      g_strfreev(lines);
+    }
+    g_array_free(st.ends, TRUE);
+    g_array_free(st.path, TRUE);
+    p2p_workspace_free(st.ws);
+    landmarks_free(st.landmarks);
+    ch_graph_free(st.hierarchy);
+    csr_graph_free(st.reverse);
+    csr_graph_free(csr);
+    g_free(trailer);
+    return 0;
+  }
 
-  // Applies the chosen algorithm on G
   // If the min weight is less than 0.0, suggests using spt.l
-  if(min_w < 0) {
+  if(csr->min_weight < 0 && opts.algorithm != -1 && opts.algorithm != SPT_L && opts.algorithm != SPT_LP) {
     g_warning("There is a negative edge in the graph: using SPT.L is strongly suggested");
   }
 
-  line = readline("Choose an algorithm to apply on G\nDijkstra (SPT.S) [0]\nBellman-Ford (SPT.L) [1]\n");
-  long int choice = strtol(line, NULL, 10);
-  if (choice < 0 || choice >= N_IMPLEMENTED)
-  {
-    g_error("Sorry, this algorithm has not been implemented yet");
+  // the vertices printed (if not all of them)
+  if(vertices_arg) {
+    opts.vertices = g_array_new(FALSE, FALSE, sizeof(int));
+    if(parse_roots(vertices_arg, csr->order, opts.vertices) == 0) {
+      g_error("No valid vertex to print given with -x");
+    }
+  }
+  if(targets_arg) {
+    opts.targets = g_array_new(FALSE, FALSE, sizeof(int));
+    if(parse_roots(targets_arg, csr->order, opts.targets) == 0) {
+      g_error("No valid target given with -t");
+    }
+  }
+  if(subtrees_arg) {
+    opts.subtrees = g_array_new(FALSE, FALSE, sizeof(int));
+    if(parse_roots(subtrees_arg, csr->order, opts.subtrees) == 0) {
+      g_error("No valid vertex given with -u");
+    }
   }
-  char *chosen_algo = (choice == 0 ? "Dijkstra" : "Bellman-Ford");
-  g_print("Run %s...\n", chosen_algo);
-  // choose the algorithm from an array of function pointers
-  int iterations = (*algorithms[choice])(graph, spt_rootlist, max_path, spt_labels, spt_pred);
 
-  // Print the resulting SPT
-  if(iterations == NO_LOWER_BOUND) {
-      puts("Negative cycle! No lower bound.");
+  // The data structure that stores the root list is a GArray
+  GArray *spt_rootlist = g_array_new(FALSE, FALSE, sizeof(int));
+  GArray *neg_cycle = g_array_new(FALSE, FALSE, sizeof(int));
+  // each node has a label: the cost of the shortest path from root to i, and
+  // a node j has a predecessor i in the SPT <=> in the SPT there is an edge i -> j
+  // The arrays and the queues of the solver are allocated once and reused by all the queries
+  SptSolver *solver = spt_solver_new(csr);
+
+  if(batch_file) {
+    // every line of the batch file is a list of roots
+    FILE *batch = fopen(batch_file, "r");
+    if(!batch) {
+      g_error("Can't open %s", batch_file);
+    }
+    char *line = NULL;
+    size_t line_size = 0;
+    // the queue disciplines other than FIFO and the cycle detection of Bellman-Ford
+    // are not among the algorithms[] that spt_batch can run
+    if(n_threads > 1 && (opts.find_cycle || opts.spt_l_queue != SPTL_FIFO)
+       && resolve_algorithm(csr, &opts) == SPT_L) {
+      g_warning("-p and -c need a single thread: -j ignored");
+      n_threads = 1;
+    }
+    // and neither are the stats, the paths and the subtrees
+    if(n_threads > 1 && (opts.stats || opts.targets || opts.subtrees)) {
+      g_warning("-s, -t and -u need a single thread: -j ignored");
+      n_threads = 1;
+    }
+    // the parallel algorithms answer the queries one by one, each on all the threads
+    if(resolve_algorithm(csr, &opts) == SPT_DS || resolve_algorithm(csr, &opts) == SPT_LP) {
+      opts.team = team_new(threads_set ? n_threads : g_get_num_processors());
+      n_threads = 1;
+    }
+    if(n_threads > 1) {
+      // all the root sets are read before the threads are started
+      GPtrArray *queries = g_ptr_array_new();
+      while(getline(&line, &line_size, batch) != -1) {
+        GArray *roots = g_array_new(FALSE, FALSE, sizeof(int));
+        if(parse_roots(line, csr->order, roots) > 0) {
+          g_ptr_array_add(queries, roots);
+        }
+        else {
+          g_array_free(roots, TRUE);
+        }
+      }
+      run_parallel_batch(csr, queries, &opts, n_threads);
+      for(int i = 0; i < queries->len; i++) {
+        g_array_free(g_ptr_array_index(queries, i), TRUE);
+      }
+      g_ptr_array_free(queries, TRUE);
+    }
+    else {
+      while(getline(&line, &line_size, batch) != -1) {
+        if(parse_roots(line, csr->order, spt_rootlist) > 0) {
+          run_query(solver, spt_rootlist, &opts, neg_cycle);
+        }
+      }
+    }
+    free(line);
+    fclose(batch);
   }
   else {
-    print_spt(chosen_algo, spt_rootlist, spt_labels, spt_pred, iterations, graph->order);
+    char *roots_line = roots_arg;
+    if(!roots_line) {
+      // the roots are on the first line after the graph, the algorithm on the next one
+      char **lines = g_strsplit(trailer ? trailer : "", "\n", 3);
+      int n = g_strv_length(lines);
+      roots_line = g_strdup(n > 0 ? lines[0] : "");
+      if(!algorithm_set && n > 1 && lines[1][0] != '\0') {
+        opts.algorithm = parse_algorithm(g_strstrip(lines[1]));
+        if(opts.algorithm == -2) {
+          g_error("Sorry, this algorithm has not been implemented yet");
+        }
+      }
+      g_strfreev(lines);
+    }
+    if(resolve_algorithm(csr, &opts) == SPT_DS || resolve_algorithm(csr, &opts) == SPT_LP) {
+      opts.team = team_new(threads_set ? n_threads : g_get_num_processors());
+    }
+    if(parse_roots(roots_line, csr->order, spt_rootlist) > 0) {
+      run_query(solver, spt_rootlist, &opts, neg_cycle);
+    }
+    else {
+      g_warning("No valid root given");
+    }
+    if(roots_line != roots_arg) {
+      g_free(roots_line);
+    }
   }
 
   // freeing all the memory before exiting
-  free(spt_labels);
-  free(spt_pred);
-  free(line);
+  spt_solver_free(solver);
+  g_free(trailer);
+  g_array_free(neg_cycle, TRUE);
   g_array_free(spt_rootlist, TRUE);
-  graph_free(graph);
+  if(opts.vertices) {
+    g_array_free(opts.vertices, TRUE);
+  }
+  if(opts.targets) {
+    g_array_free(opts.targets, TRUE);
+  }
+  if(opts.subtrees) {
+    g_array_free(opts.subtrees, TRUE);
+  }
+  team_free(opts.team);
+  csr_graph_free(csr);
 
   return 0;
 }
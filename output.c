@@ -0,0 +1,186 @@
+// Buffered writer of the SPTs: text, CSV or binary, for all the vertices or a subset
+/*
+ * output.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "output.h"
+
+#include <glib.h>
+
+// std lib header for rint: remember to link with -lm when compiling
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char *output_format_names[OUTPUT_N_FORMATS] = {"text", "csv", "binary", "cost"};
+
+Output* output_new(FILE *target) {
+  Output *out = (Output *)malloc(sizeof(Output));
+  if(!out) {
+    g_error("Output can't be alloc'd");
+  }
+  out->target = target;
+  out->len = 0;
+  out->buffer = (char *)malloc(OUTPUT_BUFFER_SIZE);
+  if(!out->buffer) {
+    g_error("Failed to alloc the output buffer");
+  }
+  return out;
+}
+
+void output_flush(Output *out) {
+  if(out->len > 0 && fwrite(out->buffer, 1, out->len, out->target) != out->len) {
+    g_error("Failed to write the output");
+  }
+  out->len = 0;
+}
+
+void output_free(Output *out) {
+  output_flush(out);
+  free(out->buffer);
+  free(out);
+}
+
+void output_bytes(Output *out, const void *data, size_t n) {
+  const char *p = data;
+  size_t chunk;
+  while(n > 0) {
+    if(out->len == OUTPUT_BUFFER_SIZE) {
+      output_flush(out);
+    }
+    chunk = MIN(n, OUTPUT_BUFFER_SIZE - out->len);
+    memcpy(out->buffer + out->len, p, chunk);
+    out->len += chunk;
+    p += chunk;
+    n -= chunk;
+  }
+}
+
+// writes the digits of v (at least min_digits, padded with zeros) at the end of the buffer
+static inline void output_digits(Output *out, guint64 v, int min_digits) {
+  char digits[24];
+  int n = 0;
+  do {
+    digits[n++] = '0' + v % 10;
+    v /= 10;
+  } while(v > 0 || n < min_digits);
+  output_reserve(out, n);
+  while(n > 0) {
+    out->buffer[out->len++] = digits[--n];
+  }
+}
+
+void output_int(Output *out, int v) {
+  if(v < 0) {
+    output_char(out, '-');
+    output_digits(out, -(gint64)v, 1);
+  }
+  else {
+    output_digits(out, v, 1);
+  }
+}
+
+void output_float3(Output *out, float x) {
+  // a float has 24 significant bits, so x * 1000 is exact in a double, and
+  // rint rounds it to an integer like printf (ties to even): the digits are
+  // the same. Huge or non-finite values are left to printf
+  double v = (double)x * 1000.0;
+  if(!(fabs(v) < 1e15)) {
+    char text[64];
+    int n = snprintf(text, sizeof(text), "%.3f", x);
+    output_bytes(out, text, n);
+    return;
+  }
+  v = rint(v);
+  // -0.0004 is printed as -0.000, like printf does
+  if(signbit(v)) {
+    output_char(out, '-');
+    v = -v;
+  }
+  guint64 scaled = (guint64)v;
+  output_digits(out, scaled / 1000, 1);
+  output_char(out, '.');
+  output_digits(out, scaled % 1000, 3);
+}
+
+// the line of vertex v in the text and CSV formats
+static inline void output_vertex(Output *out, OutputFormat format, int v, float label, int pred) {
+  if(format == OUTPUT_CSV) {
+    output_int(out, v);
+    output_char(out, ',');
+    output_float3(out, label);
+    output_char(out, ',');
+    output_int(out, pred);
+  }
+  else {
+    output_bytes(out, "label[", 6);
+    output_int(out, v);
+    output_bytes(out, "] = ", 4);
+    output_float3(out, label);
+    output_bytes(out, "\tpred[", 6);
+    output_int(out, v);
+    output_bytes(out, "] = ", 4);
+    output_int(out, pred);
+  }
+  output_char(out, '\n');
+}
+
+void output_spt(Output *out, OutputFormat format, const float *labels, const int *predecessors,
+                int order, GArray *vertices, int iterations) {
+  // without a lower bound there are no labels to write
+  int count = (iterations < 0 ? 0 : (vertices ? vertices->len : order));
+  int i, v;
+  if(format == OUTPUT_BINARY) {
+    SptResultHeader header;
+    memset(&header, 0, sizeof(SptResultHeader));
+    memcpy(header.magic, SPT_RESULT_MAGIC, 4);
+    header.version = SPT_RESULT_VERSION;
+    header.order = order;
+    header.count = count;
+    header.iterations = iterations;
+    header.has_vertices = (vertices != NULL);
+    output_bytes(out, &header, sizeof(SptResultHeader));
+    if(count == 0) {
+      return;
+    }
+    if(!vertices) {
+      // the arrays are written as they are
+      output_bytes(out, labels, order * sizeof(float));
+      output_bytes(out, predecessors, order * sizeof(int));
+      return;
+    }
+    output_bytes(out, vertices->data, count * sizeof(int));
+    for(i = 0; i < count; i++) {
+      output_bytes(out, &labels[g_array_index(vertices, int, i)], sizeof(float));
+    }
+    for(i = 0; i < count; i++) {
+      output_bytes(out, &predecessors[g_array_index(vertices, int, i)], sizeof(int));
+    }
+    return;
+  }
+  if(format == OUTPUT_CSV) {
+    output_string(out, "vertex,label,predecessor\n");
+  }
+  for(i = 0; i < count; i++) {
+    v = (vertices ? g_array_index(vertices, int, i) : i);
+    output_vertex(out, format, v, labels[v], predecessors[v]);
+  }
+}
@@ -0,0 +1,108 @@
+// Buffered writer of the SPTs: text, CSV or binary, for all the vertices or a subset (header file)
+/*
+ * output.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUT_DEFINED
+#define OUTPUT_DEFINED
+
+#include <glib.h>
+
+#include <stdio.h>
+#include <string.h>
+
+// the size of the buffer of an Output
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+// The formats of an SPT
+typedef enum output_format {
+  OUTPUT_TEXT, // "label[i] = x\tpred[i] = p" lines, between a header and the cost
+  OUTPUT_CSV, // a "vertex,label,predecessor" header, then one line per vertex
+  OUTPUT_BINARY, // a SptResultHeader, then the arrays (see below)
+  OUTPUT_COST, // only the cost of the SPT (the sum of all the labels)
+  OUTPUT_N_FORMATS
+} OutputFormat;
+
+// the names of the formats, indexed by OutputFormat
+extern const char *output_format_names[OUTPUT_N_FORMATS];
+
+/*  Binary SPT format (version 1), in the byte order of the machine that wrote it:
+    a SptResultHeader, followed by the arrays vertices[count] (only if
+    has_vertices, otherwise they're 0 .. count - 1), labels[count] and
+    predecessors[count] (32 bit integers and floats)
+*/
+#define SPT_RESULT_MAGIC "SPTR" // the first four bytes of a binary SPT
+#define SPT_RESULT_VERSION 1
+typedef struct spt_result_header_t {
+  char magic[4]; // SPT_RESULT_MAGIC
+  guint32 version; // SPT_RESULT_VERSION
+  gint32 order; // the number of vertices of the graph
+  gint32 count; // the number of vertices written
+  gint32 iterations; // the iterations of the algorithm (-1 if there's no lower bound)
+  guint32 has_vertices; // 1 if the vertices written are a subset
+} SptResultHeader;
+
+// A buffer in front of a FILE: the data is written with a single fwrite
+// per OUTPUT_BUFFER_SIZE bytes, so it stays in order with the other writes
+// to the same FILE (once flushed)
+typedef struct output_t {
+  FILE *target;
+  char *buffer;
+  size_t len; // the bytes in the buffer
+} Output;
+
+Output* output_new(FILE *target);
+// writes the buffer to the target
+void output_flush(Output *out);
+// flushes the buffer and frees out (the target is left open)
+void output_free(Output *out);
+
+// makes room for n bytes (at most OUTPUT_BUFFER_SIZE) at the end of the buffer
+static inline void output_reserve(Output *out, size_t n) {
+  if(out->len + n > OUTPUT_BUFFER_SIZE) {
+    output_flush(out);
+  }
+}
+
+static inline void output_char(Output *out, char c) {
+  output_reserve(out, 1);
+  out->buffer[out->len++] = c;
+}
+
+// writes n bytes, going around the buffer if they don't fit in it
+void output_bytes(Output *out, const void *data, size_t n);
+
+static inline void output_string(Output *out, const char *s) {
+  output_bytes(out, s, strlen(s));
+}
+
+// writes v in decimal
+void output_int(Output *out, int v);
+// writes x with three decimals, exactly as printf("%.3f", x)
+void output_float3(Output *out, float x);
+
+// Writes the SPT in the given format (which must not be OUTPUT_COST): the labels
+// and predecessors of the vertices in the array vertices, or of all of them if NULL
+// The text format only has the lines of the vertices (its header and cost are
+// the caller's); the binary one is complete. If iterations is negative (there's
+// no lower bound) no vertex is written, so the binary SPT is just its header
+void output_spt(Output *out, OutputFormat format, const float *labels, const int *predecessors,
+                int order, GArray *vertices, int iterations);
+
+#endif
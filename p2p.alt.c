@@ -0,0 +1,314 @@
+// This file contains A* with landmarks (ALT) for point-to-point queries and
+// the preprocessing that chooses the landmarks
+/*
+ * p2p.alt.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header file where this function is declared
+#include "p2p.h"
+// my functions to handle graph reading
+#include "glib-graph.h"
+// the priority queue
+#include "heap.h"
+// Dijkstra's algorithm, used to find the distances of the landmarks
+#include "spt.h"
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// allocates the landmarks and their tables (uninitialized)
+static Landmarks* landmarks_alloc(int k, int order) {
+  Landmarks *lm = (Landmarks *)malloc(sizeof(Landmarks));
+  if(!lm) {
+    g_error("Landmarks can't be alloc'd");
+  }
+  lm->k = k;
+  lm->order = order;
+  lm->vertices = (int *)malloc(k * sizeof(int));
+  lm->from = (float *)malloc((size_t)order * k * sizeof(float));
+  lm->to = (float *)malloc((size_t)order * k * sizeof(float));
+  if((!lm->vertices || !lm->from || !lm->to) && order > 0 && k > 0) {
+    g_error("Landmark tables can't be alloc'd");
+  }
+  return lm;
+}
+
+// copies the labels found from the i-th landmark in its column of table
+// (the vertices not reached get INFINITY)
+static void store_distances(Landmarks *lm, float *table, int i, const float *labels, float max_path) {
+  int v;
+  for(v = 0; v < lm->order; v++) {
+    table[(size_t)v * lm->k + i] = (labels[v] < max_path ? labels[v] : INFINITY);
+  }
+}
+
+guint32 landmarks_checksum(const CsrGraph *G) {
+  // FNV-1a on the destinations and the bits of the weights
+  guint32 hash = 2166136261u, bits;
+  int v, k;
+  for(v = 0; v < G->order; v++) {
+    for(k = G->offsets[v]; k < G->offsets[v + 1]; k++) {
+      memcpy(&bits, &G->weight[k], sizeof(guint32));
+      hash = (hash ^ (guint32)G->dest[k]) * 16777619u;
+      hash = (hash ^ bits) * 16777619u;
+    }
+    // the end of the edges of v
+    hash = (hash ^ 0xffffffffu) * 16777619u;
+  }
+  return hash;
+}
+
+Landmarks* landmarks_new(const CsrGraph *G, const CsrGraph *R, int k) {
+  if(G->min_weight < 0.0) {
+    g_error("ALT needs all the edge weights to be non-negative");
+  }
+  if(k > G->order) {
+    k = G->order;
+  }
+  Landmarks *lm = landmarks_alloc(k, G->order);
+  lm->checksum = landmarks_checksum(G);
+  if(k == 0) {
+    return lm;
+  }
+
+  float max_path = (float)(G->order) * G->max_weight + 1.0;
+  float *labels = (float *)malloc(G->order * sizeof(float));
+  int *preds = (int *)malloc(G->order * sizeof(int));
+  // the distance of each vertex from the closest landmark chosen so far
+  float *closest = (float *)malloc(G->order * sizeof(float));
+  GArray *root = g_array_sized_new(FALSE, FALSE, sizeof(int), 1);
+  Heap *Q = heap_new(G->order);
+  if(!labels || !preds || !closest) {
+    g_error("Landmark selection arrays can't be alloc'd");
+  }
+
+  int i, v, next;
+  // the first landmark is the vertex farthest from vertex 0
+  next = 0;
+  g_array_append_val(root, next);
+  spt_s_heap(G, root, max_path, labels, preds, Q, NULL);
+  for(v = 0; v < G->order; v++) {
+    if(labels[v] < max_path && labels[v] > labels[next]) {
+      next = v;
+    }
+    closest[v] = INFINITY;
+  }
+
+  for(i = 0; i < k; i++) {
+    lm->vertices[i] = next;
+    g_array_index(root, int, 0) = next;
+    spt_s_heap(G, root, max_path, labels, preds, Q, NULL);
+    store_distances(lm, lm->from, i, labels, max_path);
+    spt_s_heap(R, root, max_path, labels, preds, Q, NULL);
+    store_distances(lm, lm->to, i, labels, max_path);
+
+    // the next one is the farthest from the landmarks (preferring the
+    // vertices not reached by any of them, which no landmark can help with)
+    next = -1;
+    for(v = 0; v < G->order; v++) {
+      if(lm->from[(size_t)v * k + i] < closest[v]) {
+        closest[v] = lm->from[(size_t)v * k + i];
+      }
+      if(closest[v] > 0.0 && (next == -1 || closest[v] > closest[next])) {
+        next = v;
+      }
+    }
+    if(next == -1) {
+      // every vertex is at distance 0 from a landmark: no more are needed
+      break;
+    }
+  }
+  if(i < k) {
+    // compact the tables, that still have a column for each requested landmark
+    int chosen = i + 1, j;
+    for(v = 0; v < G->order; v++) {
+      for(j = 0; j < chosen; j++) {
+        lm->from[(size_t)v * chosen + j] = lm->from[(size_t)v * k + j];
+        lm->to[(size_t)v * chosen + j] = lm->to[(size_t)v * k + j];
+      }
+    }
+    lm->k = chosen;
+  }
+
+  heap_free(Q);
+  g_array_free(root, TRUE);
+  free(closest);
+  free(preds);
+  free(labels);
+  return lm;
+}
+
+void landmarks_save(const Landmarks *lm, const char *path) {
+  FILE *out = fopen(path, "wb");
+  if(!out) {
+    g_error("Can't open %s for writing", path);
+  }
+  LandmarksHeader header;
+  memset(&header, 0, sizeof(LandmarksHeader));
+  memcpy(header.magic, LANDMARKS_MAGIC, 4);
+  header.version = LANDMARKS_VERSION;
+  header.k = lm->k;
+  header.order = lm->order;
+  header.checksum = lm->checksum;
+  size_t n = (size_t)lm->order * lm->k;
+  if(fwrite(&header, sizeof(LandmarksHeader), 1, out) != 1
+     || fwrite(lm->vertices, sizeof(int), lm->k, out) != (size_t)lm->k
+     || fwrite(lm->from, sizeof(float), n, out) != n
+     || fwrite(lm->to, sizeof(float), n, out) != n
+     || fclose(out) != 0) {
+    g_error("Failed to write the landmarks to %s", path);
+  }
+}
+
+Landmarks* landmarks_load(const char *path, const CsrGraph *G) {
+  FILE *in = fopen(path, "rb");
+  if(!in) {
+    return NULL;
+  }
+  LandmarksHeader header;
+  if(fread(&header, sizeof(LandmarksHeader), 1, in) != 1
+     || memcmp(header.magic, LANDMARKS_MAGIC, 4) != 0
+     || header.version != LANDMARKS_VERSION
+     || header.k < 0 || header.order != G->order
+     || header.checksum != landmarks_checksum(G)) {
+    fclose(in);
+    return NULL;
+  }
+  Landmarks *lm = landmarks_alloc(header.k, header.order);
+  lm->checksum = header.checksum;
+  size_t n = (size_t)lm->order * lm->k;
+  if(fread(lm->vertices, sizeof(int), lm->k, in) != (size_t)lm->k
+     || fread(lm->from, sizeof(float), n, in) != n
+     || fread(lm->to, sizeof(float), n, in) != n) {
+    landmarks_free(lm);
+    lm = NULL;
+  }
+  fclose(in);
+  return lm;
+}
+
+void landmarks_free(Landmarks *lm) {
+  if(lm) {
+    free(lm->vertices);
+    free(lm->from);
+    free(lm->to);
+    free(lm);
+  }
+}
+
+// the lower bound on the distance from v to target given by the landmarks:
+// INFINITY if a landmark proves that there's no path (it reaches v but not
+// target, or target reaches it but v doesn't), while the other bounds
+// involving a vertex not connected to a landmark are skipped
+static inline float alt_bound(const Landmarks *lm, int v, int target) {
+  const float *from_v = lm->from + (size_t)v * lm->k;
+  const float *from_t = lm->from + (size_t)target * lm->k;
+  const float *to_v = lm->to + (size_t)v * lm->k;
+  const float *to_t = lm->to + (size_t)target * lm->k;
+  float bound = 0.0, b;
+  int i;
+  for(i = 0; i < lm->k; i++) {
+    if((!isinf(from_v[i]) && isinf(from_t[i])) || (!isinf(to_t[i]) && isinf(to_v[i]))) {
+      return INFINITY;
+    }
+    // d(v, t) >= d(v, L) - d(t, L)
+    if(!isinf(to_v[i]) && !isinf(to_t[i])) {
+      b = to_v[i] - to_t[i];
+      if(b > bound) {
+        bound = b;
+      }
+    }
+    // d(v, t) >= d(L, t) - d(L, v)
+    if(!isinf(from_t[i]) && !isinf(from_v[i])) {
+      b = from_t[i] - from_v[i];
+      if(b > bound) {
+        bound = b;
+      }
+    }
+  }
+  return bound;
+}
+
+float p2p_alt(
+  const CsrGraph *G,
+  const Landmarks *lm,
+  P2pWorkspace *ws,
+  int source,
+  int target,
+  GArray *path,
+  int *settled
+)
+{
+  if(G->min_weight < 0.0) {
+    g_error("A* needs all the edge weights to be non-negative");
+  }
+  if(lm && lm->order != G->order) {
+    g_error("The landmarks belong to a graph of %d vertices, not %d", lm->order, G->order);
+  }
+  p2p_workspace_reset(ws);
+
+  // only the forward side of the workspace is used: the key of a vertex in
+  // the queue is its label plus the lower bound on its distance to target
+  int count_settled = 0;
+  int u, v, k;
+  float label, bound = (lm ? alt_bound(lm, source, target) : 0.0);
+  p2p_set_label(ws, 0, source, 0.0, -1);
+  if(!isinf(bound)) {
+    heap_push(ws->Q[0], source, bound);
+  }
+
+  while(!heap_is_empty(ws->Q[0])) {
+    u = heap_pop(ws->Q[0], NULL);
+    count_settled++;
+    if(u == target) {
+      break;
+    }
+    for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+      v = G->dest[k];
+      label = ws->dist[0][u] + G->weight[k];
+      if(label < ws->dist[0][v]) {
+        bound = (lm ? alt_bound(lm, v, target) : 0.0);
+        if(isinf(bound)) {
+          // target can't be reached from v
+          continue;
+        }
+        p2p_set_label(ws, 0, v, label, u);
+        // with a consistent bound v isn't extracted again, but rounding
+        // may let it come back: the heap takes it in again in that case
+        heap_push_or_decrease(ws->Q[0], v, label + bound);
+      }
+    }
+  }
+
+  float cost = ws->dist[0][target];
+  if(path) {
+    g_array_set_size(path, 0);
+    if(!isinf(cost)) {
+      p2p_append_path(ws, target, path);
+    }
+  }
+  if(settled) {
+    *settled = count_settled;
+  }
+  return cost;
+}
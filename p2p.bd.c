@@ -0,0 +1,191 @@
+// This file contains the bidirectional version of Dijkstra's algorithm, for
+// point-to-point queries
+/*
+ * p2p.bd.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header file where this function is declared
+#include "p2p.h"
+// my functions to handle graph reading
+#include "glib-graph.h"
+// the priority queue
+#include "heap.h"
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+P2pWorkspace* p2p_workspace_new(int order) {
+  P2pWorkspace *ws = (P2pWorkspace *)malloc(sizeof(P2pWorkspace));
+  if(!ws) {
+    g_error("P2pWorkspace can't be alloc'd");
+  }
+  ws->order = order;
+  int side, i;
+  for(side = 0; side < 2; side++) {
+    ws->dist[side] = (float *)malloc(order * sizeof(float));
+    ws->pred[side] = (int *)malloc(order * sizeof(int));
+    if((!ws->dist[side] || !ws->pred[side]) && order > 0) {
+      g_error("P2pWorkspace arrays can't be alloc'd");
+    }
+    for(i = 0; i < order; i++) {
+      ws->dist[side][i] = INFINITY;
+      ws->pred[side][i] = -1;
+    }
+    ws->Q[side] = heap_new(order);
+  }
+  ws->touched = g_array_new(FALSE, FALSE, sizeof(int));
+  return ws;
+}
+
+void p2p_workspace_free(P2pWorkspace *ws) {
+  if(ws) {
+    int side;
+    for(side = 0; side < 2; side++) {
+      free(ws->dist[side]);
+      free(ws->pred[side]);
+      heap_free(ws->Q[side]);
+    }
+    g_array_free(ws->touched, TRUE);
+    free(ws);
+  }
+}
+
+void p2p_workspace_reset(P2pWorkspace *ws) {
+  int i, v;
+  for(i = 0; i < ws->touched->len; i++) {
+    v = g_array_index(ws->touched, int, i);
+    ws->dist[0][v] = ws->dist[1][v] = INFINITY;
+    ws->pred[0][v] = ws->pred[1][v] = -1;
+  }
+  g_array_set_size(ws->touched, 0);
+  heap_clear(ws->Q[0]);
+  heap_clear(ws->Q[1]);
+}
+
+void p2p_append_path(const P2pWorkspace *ws, int v, GArray *path) {
+  int first = path->len, last, tmp;
+  for(; v != -1; v = ws->pred[0][v]) {
+    g_array_append_val(path, v);
+  }
+  // the vertices were appended from v back to the source
+  for(last = path->len - 1; first < last; first++, last--) {
+    tmp = g_array_index(path, int, first);
+    g_array_index(path, int, first) = g_array_index(path, int, last);
+    g_array_index(path, int, last) = tmp;
+  }
+}
+
+// stores in path the vertices from source to a (following the forward
+// predecessors), then from b to target (following the backward ones)
+static void build_path(P2pWorkspace *ws, int a, int b, GArray *path) {
+  int v;
+  g_array_set_size(path, 0);
+  p2p_append_path(ws, a, path);
+  for(v = b; v != -1; v = ws->pred[1][v]) {
+    g_array_append_val(path, v);
+  }
+}
+
+float p2p_bidijkstra(
+  const CsrGraph *G,
+  const CsrGraph *R,
+  P2pWorkspace *ws,
+  int source,
+  int target,
+  GArray *path,
+  int *settled
+)
+{
+  if (G->min_weight < 0.0)
+  {
+    g_error("Bidirectional Dijkstra needs all the edge weights to be non-negative");
+  }
+  p2p_workspace_reset(ws);
+
+  const CsrGraph *graph[2] = {G, R};
+  p2p_set_label(ws, 0, source, 0.0, -1);
+  p2p_set_label(ws, 1, target, 0.0, -1);
+  heap_push(ws->Q[0], source, 0.0);
+  heap_push(ws->Q[1], target, 0.0);
+
+  // the best path found so far goes from source to meet_a, then through
+  // the edge meet_a -> meet_b, then from meet_b to target
+  float best = (source == target ? 0.0 : INFINITY);
+  int meet_a = source, meet_b = target;
+  int count_settled = 0;
+  int side, u, v, k;
+  float key[2], label;
+
+  while (!heap_is_empty(ws->Q[0]) && !heap_is_empty(ws->Q[1]))
+  {
+    key[0] = heap_min_key(ws->Q[0]);
+    key[1] = heap_min_key(ws->Q[1]);
+    // no path through a vertex not yet extracted can be cheaper
+    if (key[0] + key[1] >= best)
+    {
+      break;
+    }
+    side = (key[0] <= key[1] ? 0 : 1);
+    u = heap_pop(ws->Q[side], NULL);
+    count_settled++;
+
+    for (k = graph[side]->offsets[u]; k < graph[side]->offsets[u + 1]; k++)
+    {
+      v = graph[side]->dest[k];
+      label = ws->dist[side][u] + graph[side]->weight[k];
+      if (label < ws->dist[side][v])
+      {
+        p2p_set_label(ws, side, v, label, u);
+        heap_push_or_decrease(ws->Q[side], v, label);
+      }
+      // the edge joins the two searches
+      if (label + ws->dist[1 - side][v] < best)
+      {
+        best = label + ws->dist[1 - side][v];
+        // in the direction of G the edge is u -> v for the forward search, v -> u otherwise
+        meet_a = (side == 0 ? u : v);
+        meet_b = (side == 0 ? v : u);
+      }
+    }
+  }
+
+  if (path)
+  {
+    if (isinf(best))
+    {
+      g_array_set_size(path, 0);
+    }
+    else if (source == target)
+    {
+      g_array_set_size(path, 0);
+      g_array_append_val(path, source);
+    }
+    else
+    {
+      build_path(ws, meet_a, meet_b, path);
+    }
+  }
+  if (settled)
+  {
+    *settled = count_settled;
+  }
+  return best;
+}
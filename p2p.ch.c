@@ -0,0 +1,477 @@
+// This file contains the contraction hierarchies: the preprocessing that contracts
+// the vertices and the bidirectional query on the resulting hierarchy
+/*
+ * p2p.ch.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header file where this function is declared
+#include "p2p.h"
+// my functions to handle graph reading
+#include "glib-graph.h"
+// the priority queue
+#include "heap.h"
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+// the witness searches stop after settling this many vertices: a shortcut is
+// added whenever no witness is found, so stopping early adds a few more
+// shortcuts than needed, but never gives wrong distances
+#define CH_WITNESS_SETTLED 100
+
+// An edge of the graph being contracted
+typedef struct ch_edge_t {
+  int v; // the other end
+  float w;
+  int mid; // the vertex skipped if it's a shortcut, otherwise -1
+} ChEdge;
+
+// The state of the contraction
+typedef struct ch_builder_t {
+  // the edges leaving and entering each vertex: a contracted vertex is
+  // removed from the lists of the others, and its own are left as they were
+  GArray **out;
+  GArray **in;
+  int *deleted; // the number of contracted neighbours of each vertex
+  int *updated; // the last vertex whose contraction updated each vertex's priority
+  // the scratch space of the witness searches: the targets of the current
+  // one are the vertices with target[x] == stamp
+  float *dist;
+  int *target;
+  int stamp;
+  GArray *touched;
+  Heap *Q;
+  GArray *shortcuts; // the shortcuts found by contract (as pairs of ChEdge)
+} ChBuilder;
+
+// adds the edge u -> v to the lists of (u, v): if u -> v is already there
+// only the lighter of the two is kept
+static void add_edge(GArray **list, int u, int v, float w, int mid) {
+  ChEdge *e;
+  int i;
+  for(i = 0; i < list[u]->len; i++) {
+    e = &g_array_index(list[u], ChEdge, i);
+    if(e->v == v) {
+      if(w < e->w) {
+        e->w = w;
+        e->mid = mid;
+      }
+      return;
+    }
+  }
+  ChEdge edge = {v, w, mid};
+  g_array_append_val(list[u], edge);
+}
+
+// removes the edge towards v from the list of u
+static void remove_edge(GArray **list, int u, int v) {
+  int i;
+  for(i = 0; i < list[u]->len; i++) {
+    if(g_array_index(list[u], ChEdge, i).v == v) {
+      g_array_remove_index_fast(list[u], i);
+      return;
+    }
+  }
+}
+
+// the distances from source in the remaining graph without avoid, found by a
+// Dijkstra stopped when the n_targets targets are settled, at the limit or
+// after CH_WITNESS_SETTLED vertices
+static void witness_search(ChBuilder *b, int source, int avoid, float limit, int n_targets) {
+  int i, u, count = 0;
+  float key, label;
+  ChEdge *e;
+  for(i = 0; i < b->touched->len; i++) {
+    b->dist[g_array_index(b->touched, int, i)] = INFINITY;
+  }
+  g_array_set_size(b->touched, 0);
+  heap_clear(b->Q);
+
+  b->dist[source] = 0.0;
+  g_array_append_val(b->touched, source);
+  heap_push(b->Q, source, 0.0);
+  while(!heap_is_empty(b->Q) && count++ < CH_WITNESS_SETTLED) {
+    u = heap_pop(b->Q, &key);
+    if(key > limit || (b->target[u] == b->stamp && --n_targets == 0)) {
+      break;
+    }
+    for(i = 0; i < b->out[u]->len; i++) {
+      e = &g_array_index(b->out[u], ChEdge, i);
+      if(e->v == avoid) {
+        continue;
+      }
+      label = key + e->w;
+      if(label < b->dist[e->v]) {
+        if(isinf(b->dist[e->v])) {
+          g_array_append_val(b->touched, e->v);
+        }
+        b->dist[e->v] = label;
+        heap_push_or_decrease(b->Q, e->v, label);
+      }
+    }
+  }
+}
+
+// finds the shortcuts needed to contract v (stored in b->shortcuts) and
+// returns how many they are
+static int contract(ChBuilder *b, int v) {
+  int i, j, n_targets;
+  float limit;
+  ChEdge *in_e, *out_e;
+  g_array_set_size(b->shortcuts, 0);
+  for(i = 0; i < b->in[v]->len; i++) {
+    in_e = &g_array_index(b->in[v], ChEdge, i);
+    // the longest path through v that a witness must beat
+    limit = -INFINITY;
+    n_targets = 0;
+    b->stamp++;
+    for(j = 0; j < b->out[v]->len; j++) {
+      out_e = &g_array_index(b->out[v], ChEdge, j);
+      if(out_e->v != in_e->v) {
+        limit = MAX(limit, in_e->w + out_e->w);
+        b->target[out_e->v] = b->stamp;
+        n_targets++;
+      }
+    }
+    if(n_targets == 0) {
+      continue;
+    }
+    witness_search(b, in_e->v, v, limit, n_targets);
+    for(j = 0; j < b->out[v]->len; j++) {
+      out_e = &g_array_index(b->out[v], ChEdge, j);
+      if(out_e->v != in_e->v && !(b->dist[out_e->v] <= in_e->w + out_e->w)) {
+        // no witness: u -> v -> x must be kept by a shortcut u -> x
+        ChEdge pair[2] = {{in_e->v, in_e->w + out_e->w, v}, {out_e->v, 0.0, v}};
+        g_array_append_vals(b->shortcuts, pair, 2);
+      }
+    }
+  }
+  return b->shortcuts->len / 2;
+}
+
+// the importance of v: the lower, the sooner it's contracted
+static float priority(ChBuilder *b, int v) {
+  int degree = b->in[v]->len + b->out[v]->len;
+  return (float)(contract(b, v) - degree + b->deleted[v]);
+}
+
+// builds the CSR graph of the edges in lists (with their mid in *mid),
+// keeping only those towards vertices of higher rank
+static CsrGraph* ch_csr(GArray **lists, const int *rank, int order, int **mid) {
+  CsrGraph *g = (CsrGraph *)malloc(sizeof(CsrGraph));
+  if(!g) {
+    g_error("CsrGraph can't be alloc'd");
+  }
+  int v, i, k = 0;
+  for(v = 0; v < order; v++) {
+    for(i = 0; i < lists[v]->len; i++) {
+      k += (rank[g_array_index(lists[v], ChEdge, i).v] > rank[v]);
+    }
+  }
+  g->order = order;
+  g->size = k;
+  g->offsets = (int *)malloc((order + 1) * sizeof(int));
+  g->dest = (int *)malloc(k * sizeof(int));
+  g->weight = (float *)malloc(k * sizeof(float));
+  *mid = (int *)malloc(k * sizeof(int));
+  if(!g->offsets || ((!g->dest || !g->weight || !*mid) && k > 0)) {
+    g_error("CSR arrays can't be alloc'd");
+  }
+  g->min_weight = INFINITY;
+  g->max_weight = -INFINITY;
+  g->mapping = NULL;
+  g->mapping_size = 0;
+  ChEdge *e;
+  k = 0;
+  for(v = 0; v < order; v++) {
+    g->offsets[v] = k;
+    for(i = 0; i < lists[v]->len; i++) {
+      e = &g_array_index(lists[v], ChEdge, i);
+      if(rank[e->v] > rank[v]) {
+        g->dest[k] = e->v;
+        g->weight[k] = e->w;
+        (*mid)[k] = e->mid;
+        g->min_weight = MIN(g->min_weight, e->w);
+        g->max_weight = MAX(g->max_weight, e->w);
+        k++;
+      }
+    }
+  }
+  g->offsets[order] = k;
+  return g;
+}
+
+ChGraph* ch_graph_new(const CsrGraph *G) {
+  if(G->min_weight < 0.0) {
+    g_error("Contraction hierarchies need all the edge weights to be non-negative");
+  }
+  ChBuilder b;
+  b.out = (GArray **)malloc(G->order * sizeof(GArray *));
+  b.in = (GArray **)malloc(G->order * sizeof(GArray *));
+  b.deleted = (int *)malloc(G->order * sizeof(int));
+  b.dist = (float *)malloc(G->order * sizeof(float));
+  b.updated = (int *)malloc(G->order * sizeof(int));
+  b.target = (int *)malloc(G->order * sizeof(int));
+  b.stamp = 0;
+  ChGraph *H = (ChGraph *)malloc(sizeof(ChGraph));
+  if(!H) {
+    g_error("ChGraph can't be alloc'd");
+  }
+  H->order = G->order;
+  H->rank = (int *)malloc(G->order * sizeof(int));
+  H->shortcuts = 0;
+  if((!b.out || !b.in || !b.deleted || !b.dist || !b.updated || !b.target || !H->rank) && G->order > 0) {
+    g_error("Contraction arrays can't be alloc'd");
+  }
+  b.touched = g_array_new(FALSE, FALSE, sizeof(int));
+  b.shortcuts = g_array_new(FALSE, FALSE, sizeof(ChEdge));
+  b.Q = heap_new(G->order);
+
+  int u, v, i, k;
+  for(v = 0; v < G->order; v++) {
+    b.out[v] = g_array_new(FALSE, FALSE, sizeof(ChEdge));
+    b.in[v] = g_array_new(FALSE, FALSE, sizeof(ChEdge));
+    b.deleted[v] = 0;
+    b.updated[v] = -1;
+    b.target[v] = 0;
+    b.dist[v] = INFINITY;
+  }
+  // the self loops are never part of a shortest path
+  for(u = 0; u < G->order; u++) {
+    for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+      if(G->dest[k] != u) {
+        add_edge(b.out, u, G->dest[k], G->weight[k], -1);
+        add_edge(b.in, G->dest[k], u, G->weight[k], -1);
+      }
+    }
+  }
+
+  // the order of contraction: the witness searches use b.Q, so the vertices
+  // wait in a queue of their own
+  Heap *order = heap_new(G->order);
+  for(v = 0; v < G->order; v++) {
+    heap_push(order, v, priority(&b, v));
+  }
+  int next_rank = 0;
+  float key, p;
+  ChEdge *e;
+  while(!heap_is_empty(order)) {
+    v = heap_pop(order, &key);
+    // the priority may have grown since it was computed: if so, v waits
+    p = priority(&b, v);
+    if(!heap_is_empty(order) && p > heap_min_key(order)) {
+      heap_push(order, v, p);
+      continue;
+    }
+    // the shortcuts are the ones found by priority
+    for(i = 0; i < b.shortcuts->len; i += 2) {
+      ChEdge *from = &g_array_index(b.shortcuts, ChEdge, i);
+      ChEdge *to = &g_array_index(b.shortcuts, ChEdge, i + 1);
+      add_edge(b.out, from->v, to->v, from->w, v);
+      add_edge(b.in, to->v, from->v, from->w, v);
+    }
+    H->shortcuts += b.shortcuts->len / 2;
+    H->rank[v] = next_rank++;
+    // v leaves the lists of its neighbours, so that the witness searches
+    // don't scan it again (its own lists become its edges in the hierarchy)
+    for(i = 0; i < b.out[v]->len; i++) {
+      remove_edge(b.in, g_array_index(b.out[v], ChEdge, i).v, v);
+    }
+    for(i = 0; i < b.in[v]->len; i++) {
+      remove_edge(b.out, g_array_index(b.in[v], ChEdge, i).v, v);
+    }
+    // each neighbour has one more contracted neighbour: its priority grows by
+    // one now, the change of its edge difference is found when it's popped
+    for(i = 0; i < b.out[v]->len + b.in[v]->len; i++) {
+      e = (i < b.out[v]->len ? &g_array_index(b.out[v], ChEdge, i)
+           : &g_array_index(b.in[v], ChEdge, i - b.out[v]->len));
+      if(b.updated[e->v] != v) {
+        b.updated[e->v] = v;
+        b.deleted[e->v]++;
+        heap_update_key(order, e->v, heap_key(order, e->v) + 1.0);
+      }
+    }
+  }
+  heap_free(order);
+
+  // the edges of each vertex towards the ones contracted later form the hierarchy
+  H->up = ch_csr(b.out, H->rank, G->order, &H->up_mid);
+  H->down = ch_csr(b.in, H->rank, G->order, &H->down_mid);
+
+  for(v = 0; v < G->order; v++) {
+    g_array_free(b.out[v], TRUE);
+    g_array_free(b.in[v], TRUE);
+  }
+  free(b.out);
+  free(b.in);
+  free(b.deleted);
+  free(b.updated);
+  free(b.target);
+  free(b.dist);
+  g_array_free(b.touched, TRUE);
+  g_array_free(b.shortcuts, TRUE);
+  heap_free(b.Q);
+  return H;
+}
+
+void ch_graph_free(ChGraph *H) {
+  if(H) {
+    free(H->rank);
+    csr_graph_free(H->up);
+    free(H->up_mid);
+    csr_graph_free(H->down);
+    free(H->down_mid);
+    free(H);
+  }
+}
+
+// returns the index of the edge a -> b of the hierarchy in the up edges of a
+// (if rank[a] < rank[b]) or in the down edges of b (otherwise), storing its
+// mid in *mid
+static int ch_edge(const ChGraph *H, int a, int b, int *mid) {
+  const CsrGraph *g = (H->rank[a] < H->rank[b] ? H->up : H->down);
+  const int *mids = (H->rank[a] < H->rank[b] ? H->up_mid : H->down_mid);
+  int from = (H->rank[a] < H->rank[b] ? a : b);
+  int to = (H->rank[a] < H->rank[b] ? b : a);
+  int k;
+  for(k = g->offsets[from]; k < g->offsets[from + 1]; k++) {
+    if(g->dest[k] == to) {
+      *mid = mids[k];
+      return k;
+    }
+  }
+  g_error("%d -> %d is not an edge of the hierarchy", a, b);
+  return -1;
+}
+
+// appends to path the vertices after a on the edge a -> b of the hierarchy,
+// replacing each shortcut with the two edges it skips, and adds their weights
+// to *cost in the same order
+static void unpack(const ChGraph *H, int a, int b, GArray *path, GArray *stack, float *cost) {
+  int mid, k, pair[2] = {a, b};
+  g_array_set_size(stack, 0);
+  g_array_append_vals(stack, pair, 2);
+  while(stack->len > 0) {
+    a = g_array_index(stack, int, stack->len - 2);
+    b = g_array_index(stack, int, stack->len - 1);
+    g_array_set_size(stack, stack->len - 2);
+    k = ch_edge(H, a, b, &mid);
+    if(mid == -1) {
+      *cost += (H->rank[a] < H->rank[b] ? H->up : H->down)->weight[k];
+      g_array_append_val(path, b);
+    }
+    else {
+      // a -> mid is unpacked first, so it's pushed last
+      int halves[4] = {mid, b, a, mid};
+      g_array_append_vals(stack, halves, 4);
+    }
+  }
+}
+
+float p2p_ch(
+  const ChGraph *H,
+  P2pWorkspace *ws,
+  int source,
+  int target,
+  GArray *path,
+  int *settled
+)
+{
+  p2p_workspace_reset(ws);
+  const CsrGraph *graph[2] = {H->up, H->down};
+  p2p_set_label(ws, 0, source, 0.0, -1);
+  p2p_set_label(ws, 1, target, 0.0, -1);
+  heap_push(ws->Q[0], source, 0.0);
+  heap_push(ws->Q[1], target, 0.0);
+
+  // the best path found so far goes up from source to meet, then down to target
+  float best = (source == target ? 0.0 : INFINITY);
+  int meet = source;
+  int count_settled = 0;
+  int side, u, v, k;
+  float label;
+  while(!heap_is_empty(ws->Q[0]) || !heap_is_empty(ws->Q[1])) {
+    // the side with the smaller label goes on: both searches are complete
+    // once no label in their queue is less than the best path
+    if(heap_is_empty(ws->Q[1])
+       || (!heap_is_empty(ws->Q[0]) && heap_min_key(ws->Q[0]) <= heap_min_key(ws->Q[1]))) {
+      side = 0;
+    }
+    else {
+      side = 1;
+    }
+    if(heap_min_key(ws->Q[side]) >= best) {
+      break;
+    }
+    u = heap_pop(ws->Q[side], NULL);
+    count_settled++;
+    // stall on demand: if an edge from a more important vertex reaches u with
+    // a lower label, the label of u isn't its distance and its edges can wait
+    for(k = graph[1 - side]->offsets[u]; k < graph[1 - side]->offsets[u + 1]; k++) {
+      if(ws->dist[side][graph[1 - side]->dest[k]] + graph[1 - side]->weight[k] < ws->dist[side][u]) {
+        break;
+      }
+    }
+    if(k < graph[1 - side]->offsets[u + 1]) {
+      continue;
+    }
+    for(k = graph[side]->offsets[u]; k < graph[side]->offsets[u + 1]; k++) {
+      v = graph[side]->dest[k];
+      label = ws->dist[side][u] + graph[side]->weight[k];
+      if(label < ws->dist[side][v]) {
+        p2p_set_label(ws, side, v, label, u);
+        heap_push_or_decrease(ws->Q[side], v, label);
+        if(label + ws->dist[1 - side][v] < best) {
+          best = label + ws->dist[1 - side][v];
+          meet = v;
+        }
+      }
+    }
+  }
+
+  if(path || !isinf(best)) {
+    GArray *vertices = (path ? path : g_array_new(FALSE, FALSE, sizeof(int)));
+    GArray *stack = g_array_new(FALSE, FALSE, sizeof(int));
+    GArray *up = g_array_new(FALSE, FALSE, sizeof(int));
+    g_array_set_size(vertices, 0);
+    if(!isinf(best)) {
+      // the edges of the hierarchy from source to meet, then to target
+      p2p_append_path(ws, meet, up);
+      for(v = ws->pred[1][meet]; v != -1; v = ws->pred[1][v]) {
+        g_array_append_val(up, v);
+      }
+      best = 0.0;
+      g_array_append_val(vertices, source);
+      for(k = 0; k + 1 < up->len; k++) {
+        unpack(H, g_array_index(up, int, k), g_array_index(up, int, k + 1), vertices, stack, &best);
+      }
+    }
+    g_array_free(up, TRUE);
+    g_array_free(stack, TRUE);
+    if(!path) {
+      g_array_free(vertices, TRUE);
+    }
+  }
+  if(settled) {
+    *settled = count_settled;
+  }
+  return best;
+}
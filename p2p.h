@@ -0,0 +1,172 @@
+// This header declares the point-to-point queries: the shortest path from a source
+// to a single target, without computing the whole SPT
+/*
+ * p2p.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef P2P_DEFINED
+#define P2P_DEFINED
+
+#include "glib-graph.h"
+#include "heap.h"
+
+#include <glib.h>
+
+#include <math.h>
+
+// The scratch space of the point-to-point queries, reused by consecutive
+// queries on graphs of the same order: only the labels set by a query are
+// reset by the next one, so a short query doesn't pay for the whole graph
+typedef struct p2p_workspace_t {
+  int order;
+  float *dist[2]; // the labels of the forward (0) and backward (1) searches
+  int *pred[2]; // the predecessors (for the backward search, the successors)
+  Heap *Q[2];
+  GArray *touched; // the vertices whose labels were set by the last query
+} P2pWorkspace;
+
+P2pWorkspace* p2p_workspace_new(int order);
+void p2p_workspace_free(P2pWorkspace *ws);
+// resets the labels set by the previous query
+void p2p_workspace_reset(P2pWorkspace *ws);
+// appends to path the vertices from the source of the forward search to v,
+// following the forward predecessors (in linear time: they're reversed in place)
+void p2p_append_path(const P2pWorkspace *ws, int v, GArray *path);
+
+// sets the label of v in the search side (recording v as touched the first time)
+static inline void p2p_set_label(P2pWorkspace *ws, int side, int v, float label, int pred) {
+  if(isinf(ws->dist[0][v]) && isinf(ws->dist[1][v])) {
+    g_array_append_val(ws->touched, v);
+  }
+  ws->dist[side][v] = label;
+  ws->pred[side][v] = pred;
+}
+
+// Bidirectional Dijkstra: a forward search from source on G and a backward
+// search from target on R (the reverse of G, see csr_graph_reverse) are
+// alternated, always advancing the one with the smaller label, until the
+// sum of their smallest labels reaches the cost of the best path through
+// a vertex labeled by both. All the edge weights must be non-negative
+// Returns the cost of the shortest path, INFINITY if target is unreachable
+// If path is not NULL, the vertices of the path (source ... target) are stored in it
+// If settled is not NULL, the number of vertices extracted from the queues is stored in it
+float p2p_bidijkstra(
+  const CsrGraph *G,
+  const CsrGraph *R,
+  P2pWorkspace *ws,
+  int source,
+  int target,
+  GArray *path,
+  int *settled
+);
+
+// The landmarks of ALT and the distances between them and every vertex:
+// from[v * k + i] is the distance from the i-th landmark to v, to[v * k + i]
+// the distance from v to the i-th landmark (INFINITY if there's no path),
+// so that the distances of a vertex are next to each other
+typedef struct landmarks_t {
+  int k;
+  int order;
+  guint32 checksum; // identifies the graph (see landmarks_checksum)
+  int *vertices; // the landmarks
+  float *from;
+  float *to;
+} Landmarks;
+
+// A file of landmarks is a LandmarksHeader, followed by the arrays
+// vertices[k], from[order * k], to[order * k]
+#define LANDMARKS_MAGIC "SPTL"
+#define LANDMARKS_VERSION 1
+typedef struct landmarks_header_t {
+  char magic[4];
+  guint32 version;
+  gint32 k;
+  gint32 order;
+  guint32 checksum;
+} LandmarksHeader;
+
+// Chooses k landmarks of G (R is its reverse) and finds their distances with
+// Dijkstra (spt_s_heap): each landmark is the vertex farthest from the ones
+// already chosen (the first is the farthest from vertex 0)
+// All the edge weights must be non-negative
+Landmarks* landmarks_new(const CsrGraph *G, const CsrGraph *R, int k);
+// writes the landmarks to the file at path
+void landmarks_save(const Landmarks *lm, const char *path);
+// reads the landmarks of G from the file at path: returns NULL if the file
+// can't be read or it doesn't hold landmarks of G
+Landmarks* landmarks_load(const char *path, const CsrGraph *G);
+// a hash of the edges of G, to tell whether some landmarks belong to it
+guint32 landmarks_checksum(const CsrGraph *G);
+void landmarks_free(Landmarks *lm);
+
+// A* search from source to target on G, guided by the lower bounds on the
+// distance to target given by the triangle inequality with the landmarks
+// (ALT): d(v, t) >= d(v, L) - d(t, L) and d(v, t) >= d(L, t) - d(L, v)
+// If lm is NULL the bound is 0, so this is Dijkstra's algorithm stopped as
+// soon as target is extracted. Returns and stores the same as p2p_bidijkstra
+float p2p_alt(
+  const CsrGraph *G,
+  const Landmarks *lm,
+  P2pWorkspace *ws,
+  int source,
+  int target,
+  GArray *path,
+  int *settled
+);
+
+// A contraction hierarchy of a graph: the vertices are contracted from the
+// least important to the most, and each contraction adds the shortcuts
+// needed to keep the distances between the remaining vertices
+// up holds for each vertex v the edges v -> x with rank[x] > rank[v], down
+// the edges x -> v with rank[x] > rank[v] (stored as v -> x); their mid
+// arrays hold the vertex a shortcut skips (-1 for the edges of the graph)
+typedef struct ch_graph_t {
+  int order;
+  int *rank; // the position of each vertex in the contraction order
+  CsrGraph *up;
+  int *up_mid;
+  CsrGraph *down;
+  int *down_mid;
+  int shortcuts; // the number of shortcuts added
+} ChGraph;
+
+// Contracts the vertices of G, in the order given by their edge difference
+// (the shortcuts added minus the edges removed) plus the number of their
+// neighbours already contracted, updated lazily
+// All the edge weights must be non-negative
+ChGraph* ch_graph_new(const CsrGraph *G);
+void ch_graph_free(ChGraph *H);
+
+// Bidirectional search on the hierarchy H: a forward search from source on
+// the up edges and a backward search from target on the down edges, which
+// meet at the most important vertex of the shortest path
+// The shortcuts of the path are unpacked into the vertices of G, so path[i]
+// is the predecessor of path[i + 1] as in the SPTs found by spt_s, and the
+// cost is summed along it in the same order, so that it's the label spt_s
+// gives to target. Returns and stores the same as p2p_bidijkstra
+float p2p_ch(
+  const ChGraph *H,
+  P2pWorkspace *ws,
+  int source,
+  int target,
+  GArray *path,
+  int *settled
+);
+
+#endif
@@ -0,0 +1,82 @@
+// Helpers shared by the parallel algorithms: labels with atomic updates and frontiers
+/*
+ * parallel.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "parallel.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+Frontier* frontier_new(int n_threads, int capacity) {
+  Frontier *f = (Frontier *)malloc(sizeof(Frontier));
+  if(!f) {
+    g_error("Frontier can't be alloc'd");
+  }
+  f->capacity = MAX(capacity, 1);
+  f->size = 0;
+  f->items = (int *)malloc(f->capacity * sizeof(int));
+  f->counts = (int *)malloc(n_threads * sizeof(int));
+  if(!f->items || !f->counts) {
+    g_error("Frontier arrays can't be alloc'd");
+  }
+  atomic_init(&f->next_chunk, 0);
+  return f;
+}
+
+void frontier_free(Frontier *f) {
+  if(f) {
+    free(f->items);
+    free(f->counts);
+    free(f);
+  }
+}
+
+void frontier_gather(Frontier *f, GArray *local, int id, Team *team) {
+  f->counts[id] = (local ? local->len : 0);
+  team_barrier(team);
+  // the buffers are copied one after the other, in the order of the threads
+  int i, offset = 0, total = 0;
+  for(i = 0; i < team->n_threads; i++) {
+    if(i < id) {
+      offset += f->counts[i];
+    }
+    total += f->counts[i];
+  }
+  if(id == 0) {
+    if(total > f->capacity) {
+      f->capacity = MAX(total, 2 * f->capacity);
+      f->items = (int *)realloc(f->items, f->capacity * sizeof(int));
+      if(!f->items) {
+        g_error("Failed to alloc the frontier");
+      }
+    }
+    f->size = total;
+    atomic_store(&f->next_chunk, 0);
+  }
+  team_barrier(team);
+  if(local && local->len > 0) {
+    memcpy(f->items + offset, local->data, local->len * sizeof(int));
+    g_array_set_size(local, 0);
+  }
+  team_barrier(team);
+}
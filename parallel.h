@@ -0,0 +1,108 @@
+// Helpers shared by the parallel algorithms: labels with atomic updates and frontiers (header file)
+/*
+ * parallel.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARALLEL_DEFINED
+#define PARALLEL_DEFINED
+
+#include "team.h"
+
+#include <glib.h>
+
+#include <stdatomic.h>
+#include <string.h>
+
+/*
+ * The label and the predecessor of a vertex are packed in 64 bits so that
+ * both are updated by a single compare-and-swap: the high half is the label,
+ * with its bits mapped so that the order of the floats is the order of the
+ * unsigned integers (negative labels included), the low half the predecessor.
+ * Concurrent updates of the same vertex then keep the smallest label, and
+ * the smallest predecessor among equal labels
+ */
+typedef _Atomic guint64 PackedLabel;
+
+static inline guint64 pack_label(float label, int pred) {
+  guint32 b;
+  memcpy(&b, &label, sizeof(b));
+  // negative floats are ordered backwards: flip them, and put the others above
+  b = (b & 0x80000000u ? ~b : b | 0x80000000u);
+  return ((guint64)b << 32) | (guint32)pred;
+}
+
+static inline float packed_label(guint64 p) {
+  guint32 b = (guint32)(p >> 32);
+  b = (b & 0x80000000u ? b & 0x7fffffffu : ~b);
+  float label;
+  memcpy(&label, &b, sizeof(label));
+  return label;
+}
+
+static inline int packed_pred(guint64 p) {
+  return (int)(guint32)p;
+}
+
+// Lowers the label of *slot to label (with predecessor pred) if that's smaller
+// Returns TRUE if it did, storing the previous value in *old
+static inline gboolean packed_lower(PackedLabel *slot, float label, int pred, guint64 *old) {
+  guint64 new_value = pack_label(label, pred);
+  *old = atomic_load_explicit(slot, memory_order_relaxed);
+  while(new_value < *old) {
+    if(atomic_compare_exchange_weak_explicit(slot, old, new_value,
+                                             memory_order_relaxed, memory_order_relaxed)) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+// the number of frontier vertices a thread takes at once
+#define FRONTIER_CHUNK 64
+
+// The vertices processed in parallel in a phase of an algorithm: the threads
+// take them in chunks, and put the vertices for the next phase in their own
+// buffers, which are then gathered in the frontier
+typedef struct frontier_t {
+  int *items;
+  int size;
+  int capacity;
+  atomic_int next_chunk; // the first item not taken by any thread yet
+  int *counts; // the size of the buffer of each thread, while gathering
+} Frontier;
+
+Frontier* frontier_new(int n_threads, int capacity);
+void frontier_free(Frontier *f);
+
+// Called by all the threads of team: replaces the frontier with the vertices
+// in the buffers of the threads (local can be NULL), which are emptied
+void frontier_gather(Frontier *f, GArray *local, int id, Team *team);
+
+// Takes the next chunk of the frontier: returns FALSE if there are no more,
+// otherwise the chunk is items[*start .. *end)
+static inline gboolean frontier_next_chunk(Frontier *f, int *start, int *end) {
+  *start = atomic_fetch_add(&f->next_chunk, FRONTIER_CHUNK);
+  if(*start >= f->size) {
+    return FALSE;
+  }
+  *end = MIN(*start + FRONTIER_CHUNK, f->size);
+  return TRUE;
+}
+
+#endif
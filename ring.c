@@ -0,0 +1,57 @@
+// Circular deque of vertices with an in-queue bitmap, used by spt_l
+/*
+ * ring.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "ring.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+Ring* ring_new(int capacity) {
+  Ring *q = (Ring *)malloc(sizeof(Ring));
+  if(!q) {
+    g_error("Ring can't be alloc'd");
+  }
+  q->capacity = capacity;
+  q->head = 0;
+  q->count = 0;
+  q->items = (int *)malloc(capacity * sizeof(int));
+  // one bit per vertex, rounded up to a whole word
+  q->in_queue = (guint64 *)calloc(capacity / 64 + 1, sizeof(guint64));
+  if((!q->items && capacity > 0) || !q->in_queue) {
+    g_error("Failed to alloc ring arrays");
+  }
+  return q;
+}
+
+void ring_clear(Ring *q) {
+  q->head = 0;
+  q->count = 0;
+  memset(q->in_queue, 0, (q->capacity / 64 + 1) * sizeof(guint64));
+}
+
+void ring_free(Ring *q) {
+  free(q->items);
+  free(q->in_queue);
+  free(q);
+}
@@ -0,0 +1,84 @@
+// Circular deque of vertices with an in-queue bitmap, used by spt_l (header file)
+/*
+ * ring.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RING_DEFINED
+#define RING_DEFINED
+
+#include <glib.h>
+
+// A preallocated circular array holding the vertices 0 .. capacity - 1,
+// each at most once: since membership is tracked by a bitmap, the array
+// never needs more than capacity slots and no operation allocates memory
+typedef struct ring_t {
+  int capacity;
+  int head; // the index of the first vertex in the queue
+  int count; // the number of vertices in the queue
+  int *items;
+  guint64 *in_queue; // bit v is set iff v is in the queue
+} Ring;
+
+Ring* ring_new(int capacity);
+// removes all the vertices from the queue
+void ring_clear(Ring *q);
+void ring_free(Ring *q);
+
+// operations on the bitmap
+#define RING_WORD(v) ((v) >> 6)
+#define RING_BIT(v) (G_GUINT64_CONSTANT(1) << ((v) & 63))
+
+#define ring_is_empty(q) ((q)->count == 0)
+#define ring_contains(q, v) (((q)->in_queue[RING_WORD(v)] & RING_BIT(v)) != 0)
+
+// appends v (not already in the queue) at the end of the queue
+static inline void ring_push_tail(Ring *q, int v) {
+  int tail = q->head + q->count;
+  if(tail >= q->capacity) {
+    tail -= q->capacity;
+  }
+  q->items[tail] = v;
+  q->count++;
+  q->in_queue[RING_WORD(v)] |= RING_BIT(v);
+}
+
+// inserts v (not already in the queue) at the front of the queue
+static inline void ring_push_head(Ring *q, int v) {
+  q->head = (q->head == 0 ? q->capacity : q->head) - 1;
+  q->items[q->head] = v;
+  q->count++;
+  q->in_queue[RING_WORD(v)] |= RING_BIT(v);
+}
+
+// the first vertex in the queue (which must not be empty)
+#define ring_head(q) ((q)->items[(q)->head])
+
+// removes and returns the first vertex in the queue
+static inline int ring_pop_head(Ring *q) {
+  int v = q->items[q->head];
+  q->head++;
+  if(q->head == q->capacity) {
+    q->head = 0;
+  }
+  q->count--;
+  q->in_queue[RING_WORD(v)] &= ~RING_BIT(v);
+  return v;
+}
+
+#endif
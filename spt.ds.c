@@ -0,0 +1,378 @@
+// This file contains the implementation of delta-stepping, a parallel version of
+// Dijkstra's algorithm (SPT.S) for graphs with non-negative weights
+/*
+ * spt.ds.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// my functions to handle graph reading
+#include "glib-graph.h"
+// the header file where this function is declared
+#include "spt.h"
+// the trace of the relaxations
+#include "trace.h"
+// the threads running the phases
+#include "team.h"
+// the labels with atomic updates and the frontier
+#include "parallel.h"
+
+#include <glib.h>
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Delta-stepping keeps the vertices whose label was lowered in buckets of
+ * width delta: bucket i holds the labels in [i * delta, (i + 1) * delta).
+ * The smallest nonempty bucket is emptied by relaxing the light edges
+ * (weight < delta) of all its vertices in parallel, which may put vertices
+ * in the same bucket again, until it stays empty; then the heavy edges of
+ * all the vertices removed from the bucket are relaxed once, since they can
+ * only lower labels in later buckets. With delta = min_weight this is Dial's
+ * algorithm, with delta = infinity it's Bellman-Ford.
+ * An edge lowers a label to at most max_weight above the current bucket, so
+ * the buckets are a circular array of about max_weight / delta slots, as in
+ * the Dial queue (see bucket.h): slot b % n_slots holds bucket b.
+ * The labels are lowered with a compare-and-swap (see parallel.h)
+ */
+
+// The buckets of a thread, and the vertices it removed from the current bucket
+typedef struct ds_local_t {
+  GArray **buckets; // n_slots GArray of int, indexed by bucket % n_slots (created when needed)
+  GArray *removed;
+  int iterations; // the vertices scanned by this thread
+  // the counters of this thread: summed in the caller's SptStats at the end
+  guint64 relaxations, decreases, pushes, pops;
+} DsLocal;
+
+// The state shared by the threads
+typedef struct ds_shared_t {
+  const CsrGraph *G;
+  GArray *roots;
+  float delta;
+  int n_slots; // the number of buckets in the circular array of each thread
+  PackedLabel *state; // the packed label and predecessor of each vertex
+  Frontier *frontier; // the vertices of the current bucket
+  gint64 current; // the bucket being emptied
+  Team *team;
+  DsLocal *local; // one per thread
+  gint64 *mins; // the smallest nonempty bucket of each thread
+  int max_frontier; // the largest current bucket (the frontier of a light phase)
+} DsShared;
+
+#define NO_BUCKET G_MAXINT64
+
+static inline gint64 bucket_of(float label, float delta) {
+  return (gint64)((double)label / delta);
+}
+
+// appends v to the bucket b of this thread
+static void bucket_push(DsShared *s, DsLocal *l, gint64 b, int v) {
+  GArray **bucket = &l->buckets[b % s->n_slots];
+  if(!*bucket) {
+    *bucket = g_array_new(FALSE, FALSE, sizeof(int));
+  }
+  g_array_append_val(*bucket, v);
+  l->pushes++;
+}
+
+// lowers the label of v to label_u + w (with predecessor u) if that's smaller,
+// putting v in the right bucket of this thread
+static inline void relax(DsShared *s, DsLocal *l, int u, float label_u, int v, float w) {
+  guint64 old_state;
+  if(packed_lower(&s->state[v], label_u + w, u, &old_state)) {
+    TRACE_VIOLATION(u, v, w, label_u, packed_label(old_state));
+    l->decreases++;
+    bucket_push(s, l, bucket_of(label_u + w, s->delta), v);
+  }
+}
+
+// the smallest nonempty bucket among all the threads (called by all of them)
+// All the buckets in use are in [current, current + n_slots), so one turn
+// of the circular array finds it
+static gint64 next_bucket(DsShared *s, int id, int n_threads) {
+  DsLocal *l = &s->local[id];
+  gint64 b, min = NO_BUCKET;
+  int i;
+  for(b = s->current; b < s->current + s->n_slots; b++) {
+    GArray *bucket = l->buckets[b % s->n_slots];
+    if(bucket && bucket->len > 0) {
+      min = b;
+      break;
+    }
+  }
+  s->mins[id] = min;
+  team_barrier(s->team);
+  for(i = 0; i < n_threads; i++) {
+    min = MIN(min, s->mins[i]);
+  }
+  return min;
+}
+
+// moves the bucket current of every thread to the frontier (called by all the threads)
+static void gather_frontier(DsShared *s, int id) {
+  DsLocal *l = &s->local[id];
+  frontier_gather(s->frontier, l->buckets[s->current % s->n_slots], id, s->team);
+}
+
+// relaxes the light edges of the frontier vertices still in the current bucket
+static void relax_light(DsShared *s, DsLocal *l) {
+  const CsrGraph *G = s->G;
+  int start, end, i, u, k;
+  float label_u;
+  while(frontier_next_chunk(s->frontier, &start, &end)) {
+    for(i = start; i < end; i++) {
+      u = s->frontier->items[i];
+      l->pops++;
+      label_u = packed_label(atomic_load_explicit(&s->state[u], memory_order_relaxed));
+      // u was put in the bucket more than once, or its label moved it further
+      if(bucket_of(label_u, s->delta) != s->current) {
+        continue;
+      }
+      l->iterations++;
+      g_array_append_val(l->removed, u);
+      l->relaxations += G->offsets[u + 1] - G->offsets[u];
+      for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+        if(G->weight[k] < s->delta) {
+          relax(s, l, u, label_u, G->dest[k], G->weight[k]);
+        }
+      }
+    }
+  }
+}
+
+// relaxes the heavy edges of the vertices this thread removed from the current bucket
+static void relax_heavy(DsShared *s, DsLocal *l) {
+  const CsrGraph *G = s->G;
+  int i, u, k;
+  float label_u;
+  for(i = 0; i < l->removed->len; i++) {
+    u = g_array_index(l->removed, int, i);
+    label_u = packed_label(atomic_load_explicit(&s->state[u], memory_order_relaxed));
+    for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+      if(G->weight[k] >= s->delta) {
+        relax(s, l, u, label_u, G->dest[k], G->weight[k]);
+      }
+    }
+  }
+  g_array_set_size(l->removed, 0);
+}
+
+// The body of each thread of the team
+static void delta_stepping(int id, int n_threads, gpointer data) {
+  DsShared *s = data;
+  DsLocal *l = &s->local[id];
+  gint64 b;
+  while((b = next_bucket(s, id, n_threads)) != NO_BUCKET) {
+    // all the threads found the same b: one of them stores it
+    if(id == 0) {
+      s->current = b;
+    }
+    team_barrier(s->team);
+    // the light edges can put vertices in the current bucket again
+    gather_frontier(s, id);
+    while(s->frontier->size > 0) {
+      if(id == 0) {
+        s->max_frontier = MAX(s->max_frontier, s->frontier->size);
+      }
+      relax_light(s, l);
+      gather_frontier(s, id);
+    }
+    relax_heavy(s, l);
+    team_barrier(s->team);
+  }
+}
+
+// The range of the labels in the buckets at any time: a label is lowered to at
+// most max_weight above the current bucket, plus the rounding of the float
+// labels (up to max_path = order * max_weight)
+static double ds_span(const CsrGraph *G) {
+  double max_weight = (G->max_weight > 0.0 ? G->max_weight : 0.0);
+  return max_weight + ((double)G->order * max_weight + 1.0) * FLT_EPSILON;
+}
+
+// the slots of the circular array of buckets, with a bucket on each side
+// for the rounding of the division
+static double ds_buckets(const CsrGraph *G, float delta) {
+  return ceil(ds_span(G) / delta) + 3;
+}
+
+float spt_ds_default_delta(const CsrGraph *G) {
+  // as suggested by Meyer and Sanders for random weights, delta is about the
+  // maximum weight over the average degree: each light phase then relaxes
+  // O(1) edges per vertex on average. It's never below the minimum weight,
+  // where the buckets can't be refilled and there's no benefit from smaller ones
+  float avg_degree = (G->order > 0 ? (float)G->size / G->order : 1.0);
+  float delta = G->max_weight / MAX(avg_degree, 1.0);
+  if(delta < G->min_weight) {
+    delta = G->min_weight;
+  }
+  if(!(delta > 0.0)) {
+    // all the weights are 0: a single bucket
+    delta = 1.0;
+  }
+  // and the buckets between the current one and the last one in use are few enough
+  if(ds_buckets(G, delta) > DS_MAX_BUCKETS) {
+    delta = ds_span(G) / (DS_MAX_BUCKETS / 2);
+  }
+  return delta;
+}
+
+int spt_ds_team(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  float delta,
+  Team *team,
+  SptStats *stats
+)
+{
+  if (G->min_weight < 0.0)
+  {
+    g_error("Delta-stepping needs all the edge weights to be non-negative");
+  }
+  Team *own_team = NULL;
+  if (!team)
+  {
+    team = own_team = team_new(g_get_num_processors());
+  }
+  int n_threads = team->n_threads;
+
+  DsShared s;
+  s.G = G;
+  s.roots = roots;
+  s.delta = (delta > 0.0 ? delta : spt_ds_default_delta(G));
+  double n_slots = ds_buckets(G, s.delta);
+  if (!(n_slots <= DS_MAX_BUCKETS))
+  {
+    g_error("Delta-stepping with delta %g needs %.0f buckets (at most %d): "
+            "delta must be at least about %g", s.delta, n_slots, DS_MAX_BUCKETS,
+            ds_span(G) / (DS_MAX_BUCKETS / 2));
+  }
+  s.n_slots = (int)n_slots;
+  s.team = team;
+  s.current = 0;
+  s.max_frontier = 0;
+  s.frontier = frontier_new(n_threads, roots->len);
+  s.state = (PackedLabel *)malloc(G->order * sizeof(PackedLabel));
+  s.local = (DsLocal *)malloc(n_threads * sizeof(DsLocal));
+  s.mins = (gint64 *)malloc(n_threads * sizeof(gint64));
+  if ((!s.state && G->order > 0) || !s.local || !s.mins)
+  {
+    g_error("Failed to alloc delta-stepping data");
+  }
+
+  // the same initial tree as spt_s: the roots go in the first bucket of thread 0
+  int root = g_array_index(roots, int, 0);
+  int i;
+  for (i = 0; i < G->order; i++)
+  {
+    atomic_init(&s.state[i], pack_label(max_path, root));
+  }
+  for (i = 0; i < n_threads; i++)
+  {
+    s.local[i].buckets = (GArray **)calloc(s.n_slots, sizeof(GArray *));
+    if (!s.local[i].buckets)
+    {
+      g_error("Failed to alloc the buckets of delta-stepping");
+    }
+    s.local[i].removed = g_array_new(FALSE, FALSE, sizeof(int));
+    s.local[i].iterations = 0;
+    s.local[i].relaxations = s.local[i].decreases = 0;
+    s.local[i].pushes = s.local[i].pops = 0;
+  }
+  for (i = 0; i < roots->len; i++)
+  {
+    root = g_array_index(roots, int, i);
+    if (atomic_load(&s.state[root]) != pack_label(0.0, root))
+    {
+      atomic_store(&s.state[root], pack_label(0.0, root));
+      bucket_push(&s, &s.local[0], 0, root);
+    }
+  }
+
+  team_run(team, delta_stepping, &s);
+
+  // unpack the results in the caller's arrays
+  guint64 packed;
+  int reached = 0;
+  for (i = 0; i < G->order; i++)
+  {
+    packed = atomic_load(&s.state[i]);
+    labels[i] = packed_label(packed);
+    predecessors[i] = packed_pred(packed);
+    reached += (labels[i] != max_path);
+  }
+
+  int count_it = 0;
+  int b;
+  if (stats)
+  {
+    memset(stats, 0, sizeof(SptStats));
+  }
+  for (i = 0; i < n_threads; i++)
+  {
+    count_it += s.local[i].iterations;
+    if (stats)
+    {
+      stats->relaxations += s.local[i].relaxations;
+      stats->decreases += s.local[i].decreases;
+      stats->pushes += s.local[i].pushes;
+      stats->pops += s.local[i].pops;
+    }
+    for (b = 0; b < s.n_slots; b++)
+    {
+      if (s.local[i].buckets[b])
+      {
+        g_array_free(s.local[i].buckets[b], TRUE);
+      }
+    }
+    free(s.local[i].buckets);
+    g_array_free(s.local[i].removed, TRUE);
+  }
+  free(s.local);
+  free(s.mins);
+  frontier_free(s.frontier);
+  free((void *)s.state);
+  team_free(own_team);
+
+  if (stats)
+  {
+    // every vertex reached is scanned once at its final label: the other
+    // scans follow a reinsertion in a bucket
+    stats->counted = TRUE;
+    stats->reinsertions = (count_it > reached ? count_it - reached : 0);
+    stats->max_queue = s.max_frontier;
+  }
+  return count_it;
+}
+
+int spt_ds(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors
+)
+{
+  return spt_ds_team(G, roots, max_path, labels, predecessors, 0.0, NULL, NULL);
+}
@@ -0,0 +1,211 @@
+// This file contains the repair of an SPT after some edges of the graph change
+/*
+ * spt.dyn.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// my functions to handle graph reading
+#include "glib-graph.h"
+// the header file where this function is declared
+#include "spt.h"
+// the tracing of the relaxations
+#include "trace.h"
+// the priority queue
+#include "heap.h"
+
+#include <glib.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+// cuts the subtree rooted at v from the SPT: its vertices get label INFINITY
+// and are appended to cut. The children of a vertex are found among the heads
+// of its edges, so this costs as much as the edges of the subtree
+static void cut_subtree(const CsrGraph *G, int v, float max_path, float *labels, const int *predecessors, GArray *cut) {
+  int i = cut->len, x, k, dest;
+  labels[v] = INFINITY;
+  g_array_append_val(cut, v);
+  for(; i < cut->len; i++) {
+    x = g_array_index(cut, int, i);
+    for(k = G->offsets[x]; k < G->offsets[x + 1]; k++) {
+      dest = G->dest[k];
+      // neither a vertex not reached (whose predecessor is the first root)
+      // nor one already cut is a child
+      if(predecessors[dest] == x && dest != x && labels[dest] < max_path) {
+        labels[dest] = INFINITY;
+        g_array_append_val(cut, dest);
+      }
+    }
+  }
+}
+
+int spt_repair(
+  CsrGraph *G,
+  CsrGraph *R,
+  GArray *roots,
+  float *max_path_p,
+  float *labels,
+  int *predecessors,
+  const SptChange *changes,
+  int n_changes,
+  Heap *Q
+) {
+  int i, j, k, u, v;
+  // all the changes are checked before the graph is modified
+  for(i = 0; i < n_changes; i++) {
+    if(changes[i].from < 0 || changes[i].from >= G->order
+       || changes[i].to < 0 || changes[i].to >= G->order) {
+      g_error("Change of the edge %d -> %d out of a graph of %d vertices",
+              changes[i].from, changes[i].to, G->order);
+    }
+  }
+  float *old = (float *)malloc(n_changes * sizeof(float));
+  if(!old && n_changes > 0) {
+    g_error("Failed to alloc the old weights");
+  }
+  GArray *cut = g_array_new(FALSE, FALSE, sizeof(int));
+  GArray *inserted = g_array_new(FALSE, FALSE, sizeof(CsrEdge));
+  int root = g_array_index(roots, int, 0);
+  float label;
+  float max_path = *max_path_p;
+
+  // the weights are changed in place, the missing edges are inserted together
+  for(i = 0; i < n_changes; i++) {
+    if(csr_graph_set_weight(G, changes[i].from, changes[i].to, changes[i].weight, &old[i])) {
+      csr_graph_set_weight(R, changes[i].to, changes[i].from, changes[i].weight, &label);
+    }
+    else {
+      old[i] = INFINITY;
+      if(!isinf(changes[i].weight)) {
+        g_array_append_val(inserted, changes[i]);
+      }
+    }
+  }
+  csr_graph_insert_edges(G, (CsrEdge *)inserted->data, inserted->len);
+  for(i = 0; i < inserted->len; i++) {
+    CsrEdge *e = &g_array_index(inserted, CsrEdge, i);
+    v = e->from;
+    e->from = e->to;
+    e->to = v;
+  }
+  csr_graph_insert_edges(R, (CsrEdge *)inserted->data, inserted->len);
+  g_array_free(inserted, TRUE);
+
+  // a heavier edge can raise the labels above max_path, where they would be
+  // taken for vertices not reached: the bound grows with the maximum weight,
+  // and the vertices not reached get the new one (a pass over the labels, but
+  // only in the batches that raise the maximum weight)
+  float new_max_path = (float)(G->order) * G->max_weight + 1.0;
+  if(new_max_path > max_path) {
+    for(v = 0; v < G->order; v++) {
+      if(labels[v] >= max_path) {
+        labels[v] = new_max_path;
+      }
+    }
+    max_path = *max_path_p = new_max_path;
+  }
+
+  // the subtrees below the tree edges made heavier lose their labels
+  for(i = 0; i < n_changes; i++) {
+    v = changes[i].to;
+    if(changes[i].weight > old[i] && predecessors[v] == changes[i].from && v != changes[i].from
+       && labels[v] < max_path) {
+      cut_subtree(G, v, max_path, labels, predecessors, cut);
+    }
+  }
+  // each vertex cut is linked again through its cheapest edge from a vertex
+  // with a label (in the tree, or already linked again)
+  heap_clear(Q);
+  for(j = 0; j < cut->len; j++) {
+    v = g_array_index(cut, int, j);
+    for(k = R->offsets[v]; k < R->offsets[v + 1]; k++) {
+      u = R->dest[k];
+      if(labels[u] < max_path && labels[u] + R->weight[k] < labels[v]) {
+        labels[v] = labels[u] + R->weight[k];
+        predecessors[v] = u;
+      }
+    }
+    if(!isinf(labels[v])) {
+      heap_push(Q, v, labels[v]);
+    }
+  }
+  // the edges changed may violate Bellman's condition (their current weight
+  // is used, since an edge can change many times in the same batch)
+  for(i = 0; i < n_changes; i++) {
+    u = changes[i].from;
+    if(labels[u] >= max_path) {
+      continue;
+    }
+    for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+      v = G->dest[k];
+      label = labels[u] + G->weight[k];
+      if(v == changes[i].to && label < labels[v]) {
+        TRACE_VIOLATION(u, v, G->weight[k], labels[u], labels[v]);
+        labels[v] = label;
+        predecessors[v] = u;
+        heap_push_or_decrease(Q, v, label);
+      }
+    }
+  }
+
+  // the lowered labels are propagated: a vertex lowered after its extraction
+  // (only possible with negative weights) goes back in the heap
+  // With negative weights, every G->order extractions the predecessors graph
+  // is checked for a cycle
+  int count_it = 0;
+  int *mark = NULL;
+  while(!heap_is_empty(Q)) {
+    u = heap_pop(Q, NULL);
+    count_it++;
+    for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+      v = G->dest[k];
+      label = labels[u] + G->weight[k];
+      if(label < labels[v]) {
+        TRACE_VIOLATION(u, v, G->weight[k], labels[u], labels[v]);
+        labels[v] = label;
+        predecessors[v] = u;
+        heap_push_or_decrease(Q, v, label);
+      }
+    }
+    if(G->min_weight < 0.0 && count_it % G->order == 0) {
+      if(!mark) {
+        mark = (int *)malloc(G->order * sizeof(int));
+        if(!mark) {
+          g_error("Failed to alloc the cycle check array");
+        }
+      }
+      if(pred_graph_has_cycle(predecessors, labels, G->order, roots, mark)) {
+        count_it = NO_LOWER_BOUND;
+        break;
+      }
+    }
+  }
+
+  // the vertices cut and not linked again can't be reached anymore
+  for(j = 0; j < cut->len; j++) {
+    v = g_array_index(cut, int, j);
+    if(isinf(labels[v])) {
+      labels[v] = max_path;
+      predecessors[v] = root;
+    }
+  }
+  g_array_free(cut, TRUE);
+  free(mark);
+  free(old);
+  return count_it;
+}
@@ -29,9 +29,19 @@
 
 // my functions to handle graph reading
 #include "glib-graph.h"
+// the counters, the queue disciplines of SPT.L and NO_LOWER_BOUND
+#include "libspt.h"
+// the priority queue of Dijkstra's algorithm
+#include "heap.h"
+// the queue of Bellman-Ford
+#include "ring.h"
+// the threads of delta-stepping
+#include "team.h"
 
 #include <glib.h> // Glib header for data structures (GList, GQueue, ...)
 
+#include <stdbool.h>
+
 /*
  * Definition: Bellman condition
  * Given two vertices i and j in the directed graph G = (N, A) such that
@@ -41,26 +51,286 @@
  * otherwise it's not satisfied.
  */
 
-#define NO_LOWER_BOUND -1 // if the instance has no lower bound, spt_l returns this value
+// The scratch space of the queries: reused by all the queries of a thread (or
+// of a SptSolver), so that nothing is allocated once they're started
+typedef struct spt_workspace_t {
+  int order;
+  float *labels;
+  int *predecessors;
+  Heap *Q; // used by Dijkstra (see spt_s_heap)
+  Ring *ring; // used by SPT.L (see spt_l_workspace): allocated on first use
+  int *count_rm; // the extractions of each vertex in SPT.L
+  int *mark; // the scratch space of pred_graph_has_cycle: allocated on first use
+} SptWorkspace;
+
+SptWorkspace* spt_workspace_new(int order);
+void spt_workspace_free(SptWorkspace *ws);
+
+// Both algorithms run on the CSR representation of the graph (see glib-graph.h)
+// All the given roots start with label 0 and are their own predecessors, so
+// labels and predecessors have G->order entries. The graph is never modified
+// (except by spt_repair), so many queries (each with its own arrays) can run
+// on the same graph at once
 
-// runs the Bellman-Ford algorithm (SPT.L) on G
+// runs the Bellman-Ford algorithm (SPT.L) on G, with a FIFO queue
 // returns the number of iterations needed on success
 int spt_l(
-  Graph *G,
+  const CsrGraph *G,
   GArray *roots,
   float max_path,
   float *labels,
   int *predecessors
 );
 
+// the names of the policies, indexed by SptlPolicy
+extern const char *sptl_policy_names[SPTL_N_POLICIES];
+
+// runs SPT.L on G with the given queue discipline
+// The counters of the run are stored in stats, if not NULL
+// returns the number of iterations needed on success
+int spt_l_policy(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  SptlPolicy policy,
+  SptStats *stats
+);
+
+// runs SPT.L on G with the given queue discipline, using the queue and the
+// scratch arrays of ws (which must have room for G->order vertices)
+// The counters of the run are stored in stats, if not NULL
+// returns the number of iterations needed on success
+int spt_l_workspace(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  SptlPolicy policy,
+  SptWorkspace *ws,
+  SptStats *stats
+);
+
 // runs Dijkstra's algorithm (SPT.S) on G
 // returns the number of iterations needed on success
 int spt_s(
-  Graph *G,
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors
+);
+
+// runs Dijkstra's algorithm (SPT.S) on G with the heap Q supplied by the caller,
+// which must have room for G->order vertices: it's emptied before it's used,
+// so the same heap can be reused by many queries (one at a time)
+// The counters of the run are stored in stats, if not NULL
+// returns the number of iterations needed on success
+int spt_s_heap(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  Heap *Q,
+  SptStats *stats
+);
+
+// runs SPT.L on G with a FIFO queue and Tarjan's subtree disassembly:
+// whenever the label of a node v is lowered, its subtree in the current SPT
+// is removed from the tree. If the node whose edge lowered the label is in
+// that subtree, the edge closes a negative cycle, which is detected as soon
+// as it appears in the predecessors graph (instead of after |V| passes)
+// If neg_cycle is not NULL the vertices of the cycle are stored in it, in order
+// The counters of the run are stored in stats, if not NULL
+// returns the number of iterations needed on success, NO_LOWER_BOUND otherwise
+int spt_l_tarjan(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  GArray *neg_cycle,
+  SptStats *stats
+);
+
+// Dijkstra's algorithm with a Dial bucket queue (buckets as wide as the minimum
+// edge weight): extraction is amortized O(1)
+// All the edge weights must be positive
+// returns the number of iterations needed on success
+int spt_s_dial(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors
+);
+
+// Dijkstra's algorithm with a radix heap on the bits of the (float) labels
+// All the edge weights must be non-negative
+// returns the number of iterations needed on success
+int spt_s_radix(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors
+);
+
+// The monotone priority queues of Dijkstra's algorithm (see bucket.h)
+typedef enum spts_monotone {
+  DIAL_QUEUE, // spt_s_dial
+  RADIX_HEAP // spt_s_radix
+} SptsMonotone;
+
+// runs spt_s_dial or spt_s_radix, as chosen by kind
+// The counters of the run are stored in stats, if not NULL
+int spt_s_monotone(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  SptsMonotone kind,
+  SptStats *stats
+);
+
+// Delta-stepping: Dijkstra's algorithm with buckets of width delta, each
+// emptied by relaxing the edges of all its vertices in parallel
+// All the edge weights must be non-negative; the labels are the same as spt_s
+// spt_ds uses the default delta and one thread per processor
+// returns the number of vertices scanned
+int spt_ds(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors
+);
+
+// delta-stepping with the given delta (if <= 0 the default is used) on the
+// threads of team (if NULL a team with one thread per processor is created)
+// The counters of the run are stored in stats, if not NULL (max_queue is the
+// largest bucket emptied at once)
+int spt_ds_team(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  float delta,
+  Team *team,
+  SptStats *stats
+);
+
+// the default delta of G, derived from its weights and its average degree
+float spt_ds_default_delta(const CsrGraph *G);
+
+// delta-stepping keeps at most this many buckets per thread (about
+// max_weight / delta): a smaller delta is rejected
+#define DS_MAX_BUCKETS (1 << 20)
+
+// Parallel Bellman-Ford: each round relaxes the edges of all the vertices
+// lowered in the previous round on many threads. Negative weights are allowed:
+// a negative cycle is detected when vertices are still lowered after |V| rounds
+// spt_lp uses one thread per processor
+// returns the number of vertices scanned on success, NO_LOWER_BOUND otherwise
+int spt_lp(
+  const CsrGraph *G,
   GArray *roots,
   float max_path,
   float *labels,
   int *predecessors
 );
 
+// parallel Bellman-Ford on the threads of team (if NULL a team with one
+// thread per processor is created)
+// The counters of the run are stored in stats, if not NULL (max_queue is the
+// largest frontier)
+int spt_lp_team(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  Team *team,
+  SptStats *stats
+);
+
+// the Dial queue is chosen automatically only if it needs at most this many
+// buckets (max_weight / min_weight), otherwise the radix heap is used
+#define DIAL_MAX_BUCKETS (1 << 16)
+
+// A change of the weight of the edge from -> to: INFINITY removes the edge,
+// and an edge not in the graph is inserted (see csr_graph_set_weight)
+typedef CsrEdge SptChange;
+
+// Applies the changes to G and to its reverse R, then repairs the SPT in labels
+// and predecessors (found on G before the changes, with the same roots and
+// *max_path) instead of finding it again:
+// - the subtree below each tree edge made heavier (or removed) is cut from the
+//   tree, and each of its vertices is linked again through its cheapest edge
+//   from the rest of the tree
+// - each edge changed that violates Bellman's condition lowers the label of
+//   its head
+// then the lowered labels are propagated by a label correcting search on the
+// heap Q (any heap with room for G->order vertices). The work is proportional
+// to the vertices whose labels change and to their edges, not to the graph
+// (but the edges inserted, if any, are added rebuilding G and R once)
+// Negative weights are allowed. If the changes raise the maximum weight, so
+// that a path can cost more than *max_path, it's raised to order * max_weight + 1
+// (the label of the vertices not reached): the next repairs must be given the new one
+// returns the number of iterations needed on success, NO_LOWER_BOUND if the
+// changes close a negative cycle
+int spt_repair(
+  CsrGraph *G,
+  CsrGraph *R,
+  GArray *roots,
+  float *max_path,
+  float *labels,
+  int *predecessors,
+  const SptChange *changes,
+  int n_changes,
+  Heap *Q
+);
+
+// An index of an SPT, built once in O(n): the children of each vertex (in the
+// same layout as a CsrGraph) and the preorder tour of the tree from each root,
+// so that every subtree is a contiguous range of the tour. The paths are then
+// found in O(length) and the subtrees in O(1)
+// The unreached vertices (label max_path) are in no tree: their enter is -1
+typedef struct spt_tree_t {
+  int order;
+  const int *predecessors; // the predecessors of the SPT (not copied)
+  int *child_offsets; // order + 1 entries: the children of v are in
+  int *children; // children[child_offsets[v] .. child_offsets[v + 1]), in increasing order
+  int *tour; // the reached vertices in preorder, the roots in increasing order
+  int *enter; // enter[v] is the index of v in tour (-1 if unreached)
+  int *leave; // the subtree of v is tour[enter[v] .. leave[v])
+  int *depth; // the number of edges between v and its root (-1 if unreached)
+  int *root; // the root whose tree contains v (-1 if unreached)
+  int n_reached; // the number of vertices in the tour
+} SptTree;
+
+// builds the index of the SPT given by labels and predecessors (as found by the
+// algorithms above): predecessors must not change while the index is used
+SptTree* spt_tree_new(int order, const float *labels, const int *predecessors, float max_path);
+// stores in path the vertices from the root of v to v: returns the number of
+// edges of the path, or -1 (and an empty path) if v is unreached
+int spt_tree_path(const SptTree *T, int v, GArray *path);
+// returns the vertices of the subtree of v (v first, then its descendants in
+// preorder) and stores their number in *size (NULL and 0 if v is unreached)
+const int* spt_tree_subtree(const SptTree *T, int v, int *size);
+// true if u is v or one of its ancestors
+#define spt_tree_is_ancestor(T, u, v) \
+  ((T)->enter[(u)] != -1 && (T)->enter[(u)] <= (T)->enter[(v)] && (T)->enter[(v)] < (T)->leave[(u)])
+void spt_tree_free(SptTree *T);
+
+// Checks whether the predecessors graph contains a cycle, which happens
+// (eventually) if and only if the graph contains a cycle with total weight < 0
+// mark is scratch space for num_vertices entries
+bool pred_graph_has_cycle(const int *predecessors, const float *labels, int num_vertices, GArray *roots, int *mark);
+
 #endif
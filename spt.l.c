@@ -25,153 +25,467 @@
 #include "glib-graph.h"
 // the header file where this function is declared
 #include "spt.h"
+// the trace of the relaxations
+#include "trace.h"
+// the FIFO queue
+#include "ring.h"
 
 #include <glib.h> // Glib header for data structures (GList, GQueue, ...)
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h> // to use boolean constants from C99, could be avoided
 
+const char *sptl_policy_names[SPTL_N_POLICIES] = {
+  "FIFO", "SLF", "LLL", "SLF+LLL", "Pape"
+};
+
+// Checks whether the predecessors graph contains a cycle: with any queue
+// discipline, this happens (eventually) if and only if the graph contains
+// a cycle with total weight < 0. Each vertex is visited once: mark[v] is
+// the vertex whose walk up the predecessors array first reached v
+bool pred_graph_has_cycle(const int *predecessors, const float *labels, int num_vertices, GArray *roots, int *mark) {
+    int v, x;
+    for(v = 0; v < num_vertices; v++) {
+        mark[v] = -1;
+    }
+    // the walks stop at the roots, unless their label was lowered (then they're
+    // on a negative cycle, and the walks will go around it)
+    // A vertex can only be its own predecessor with label 0 if it's a root
+    // not lowered yet: anything else means a negative self-loop
+    for(v = 0; v < roots->len; v++) {
+        x = g_array_index(roots, int, v);
+        if(predecessors[x] == x && labels[x] == 0.0) {
+            mark[x] = num_vertices;
+        }
+    }
+    for(v = 0; v < num_vertices; v++) {
+        // walk up from v until a root or an already marked vertex
+        for(x = v; mark[x] == -1; x = predecessors[x]) {
+            mark[x] = v;
+        }
+        // reaching a vertex marked during this same walk closes a cycle
+        if(mark[x] == v) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // spt_l applies Bellman-Ford on the graph G based on the list of roots
 // and outputs the labels and predecessors arrays that represent (one of)
 // the shortest paths tree
 int spt_l(
-  Graph *G,
+  const CsrGraph *G,
   GArray *roots,
   float max_path,
   float *labels,
   int *predecessors
 ) {
-    // The algorithm supports multiple roots, by adding a node connected to all
-    // the roots with weigth 0 and applying the procedure on the modified graph
-    // and the new node as the root of the spt. Afterwards, the node is removed
-    int root;
-    if(roots->len > 1) {
-      root = graph_add_hyper_root(G, roots);
-    }
-    else {
-      root = g_array_index(roots, int, 0);
-    }
+    return spt_l_policy(G, roots, max_path, labels, predecessors, SPTL_FIFO, NULL);
+}
 
-#ifdef DEBUG // prints the modified graph
-    puts("GRAPH");
-    print_graph(stdout, *G);
-#endif
+int spt_l_policy(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  SptlPolicy policy,
+  SptStats *stats
+) {
+    // the queue and the counts are used by this query only
+    SptWorkspace ws = {G->order, NULL, NULL, NULL, NULL, NULL, NULL};
+    int count_it = spt_l_workspace(G, roots, max_path, labels, predecessors, policy, &ws, stats);
+    ring_free(ws.ring);
+    free(ws.count_rm);
+    free(ws.mark);
+    return count_it;
+}
+
+int spt_l_workspace(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  SptlPolicy policy,
+  SptWorkspace *ws,
+  SptStats *stats
+) {
+    // The algorithm supports multiple roots: all of them start with label 0
+    // and are put in Q, so the graph is never modified
+    int root = g_array_index(roots, int, 0);
+    int num_vertices = G->order;
 
-    // creates an empty queue (FIFO list) to store nodes that violate Bellman conditions
-    GQueue *Q = g_queue_new();
+    // the queue and the counts are allocated by the first query of ws
+    if (!ws->ring) {
+        ws->ring = ring_new(num_vertices);
+        ws->count_rm = (int *)malloc(num_vertices * sizeof(int));
+        if (!ws->count_rm) {
+            g_error("Failed to alloc the extraction counts");
+        }
+    }
+
+    // an empty queue to store nodes that violate Bellman conditions:
+    // a FIFO list for Bellman-Ford, a deque for the other disciplines
+    // A node is in Q at most once, so a circular array of num_vertices slots
+    // is enough, and an in-queue bitmap makes the membership check O(1)
+    Ring *Q = ws->ring;
+    ring_clear(Q);
+    bool slf = (policy == SPTL_SLF || policy == SPTL_SLF_LLL);
+    bool lll = (policy == SPTL_LLL || policy == SPTL_SLF_LLL);
+    // the sum of the labels of the nodes in Q, to compute their average (LLL)
+    double queued_sum = 0.0;
 
     // An internal array to store how many times a node has been removed from Q
     // When any node reaches n insertions (and subsequent extractions),
     // then it's proved that the graph contains a cycle with total weight < 0
     // =>
     // The given graph's optimal solution has no lower bound (-inf)
-    int *count_rm = (int *)calloc(G->order, sizeof(int));
+    // This only holds for the FIFO discipline: with the others, every n
+    // extractions of a node the predecessors graph is checked for a cycle
+    int *count_rm = ws->count_rm;
+    memset(count_rm, 0, num_vertices * sizeof(int));
 
     // An initial tree is needed to start the algorithm; a simple way to obtain such
     // a tree is to connect all nodes to the root with max_w as their edge weight
     // so that this edge will always violate Bellman conditions
     int i;
-    for (i = 0; i < G->order; i++) {
-        if (i != root) {
-            labels[i] = max_path;
-        }
-        else {
-            labels[i] = 0;
-        }
+    for (i = 0; i < num_vertices; i++) {
+        labels[i] = max_path;
         predecessors[i] = root;
     }
 
     // The tail nodes of those edges who violate Bellman conditions
-    // must be inserted in Q. In this case, only the root is violating them,
+    // must be inserted in Q. In this case, only the roots are violating them,
     // because of how the initial tree has been built
-    g_queue_push_tail(Q, GINT_TO_POINTER(root));
-    // An element in Q must be stored as a gpointer, so the macro converts it from int
+    // Each root gets label 0 and is its own predecessor
+    for (i = 0; i < roots->len; i++) {
+        root = g_array_index(roots, int, i);
+        if (!ring_contains(Q, root)) {
+            labels[root] = 0;
+            predecessors[root] = root;
+            ring_push_tail(Q, root);
+        }
+    }
+
+    // the counters of the run: stored in stats at the end
+    guint64 relaxations = 0, decreases = 0, pushes = Q->count, reinsertions = 0;
+    int max_queue = Q->count;
 
     // Counts the number of iterations made by the algorithm
     int count_it = 0;
     // Flag that signals the presence of cycles whose total cost is negative
     bool neg_cycle = false;
     // Other dummy variables
-    Edge *e = NULL;
-    GSList *adjlist = NULL;
-    GList *dummy_list = NULL;
+    const int *adj_dest = NULL;
+    const float *adj_weight = NULL;
+    int k, degree, dest, rotations;
 
     // iterate while Q is not empty and a negative cycle hasn't been found
-    while (!(g_queue_is_empty(Q) || neg_cycle)) {
+    while (!(ring_is_empty(Q) || neg_cycle)) {
         count_it++;
 
-        i = GPOINTER_TO_INT(g_queue_pop_head(Q));
-        // data in Q is a gpointer, the macro converts it back to int
+        // LLL: move the first node to the back while its label is above the average
+        // (at least one label is not, so at most Q->count - 1 nodes are moved)
+        for(rotations = 0; lll && rotations < Q->count - 1; rotations++) {
+            if((double)labels[ring_head(Q)] * Q->count <= queued_sum) {
+                break;
+            }
+            ring_push_tail(Q, ring_pop_head(Q));
+        }
+        i = ring_pop_head(Q);
+        if(lll) {
+            queued_sum -= labels[i];
+        }
 
         // check if there's a negative cycle (a node has been removed |V| times)
         count_rm[i]++;
-        if(count_rm[i] == G->order) {
-            neg_cycle = true;
+        if(policy == SPTL_FIFO) {
+            if(count_rm[i] == num_vertices) {
+                neg_cycle = true;
+            }
+        }
+        else if(count_rm[i] % num_vertices == 0) {
+            if(!ws->mark) {
+                ws->mark = (int *)malloc(num_vertices * sizeof(int));
+                if(!ws->mark) {
+                    g_error("Failed to alloc cycle detection array");
+                }
+            }
+            neg_cycle = pred_graph_has_cycle(predecessors, labels, num_vertices, roots, ws->mark);
         }
 
         // Check bellman conditions of the forward edges from i
 
-        // get i's adjacency list
-        // TODO: Replace with the correct call to g_list_find_custom to find
-        // the i-th vertex's adjacency list
-        dummy_list = G->nodes;
-        while(dummy_list && ((Node *)dummy_list->data)->vertex != i) {
-          dummy_list = dummy_list->next;
-        }
-        adjlist = ((Node *)dummy_list->data)->adjacent;
+        // get i's adjacency list: a slice of the CSR arrays
+        adj_dest = G->dest + G->offsets[i];
+        adj_weight = G->weight + G->offsets[i];
+        degree = G->offsets[i + 1] - G->offsets[i];
+        relaxations += degree;
 
 #ifdef DEBUG // prints the adjacency list of node i
-        g_print("Node %d\'s adjacency list:\n[\n", ((Node *)dummy_list->data)->vertex);
-        GSList *ss = adjlist;
-        while(ss) {
-          Edge *ee = ss->data;
-          g_print("\t{dest = %d, weight = %.3f} ->\n", ee->destination, ee->weight);
-          ss = ss->next;
+        g_print("Node %d\'s adjacency list:\n[\n", i);
+        for(k = 0; k < degree; k++) {
+          g_print("\t{dest = %d, weight = %.3f} ->\n", adj_dest[k], adj_weight[k]);
         }
         g_print("\tNULL\n]\n");
 #endif
 
-        // Iterate over all the elements in the list
-        while (adjlist != NULL) {
-            e = (Edge *)adjlist->data;
+        // Iterate over all the edges in the list
+        for(k = 0; k < degree; k++) {
+            dest = adj_dest[k];
+
+            if (labels[dest] > labels[i] + adj_weight[k]) {
+                TRACE_VIOLATION(i, dest, adj_weight[k], labels[i], labels[dest]);
+                decreases++;
 
-            if (labels[e->destination] > labels[i] + e->weight) {
-                printf("(%d, %d) violates Bellman\n", i, e->destination);
-                printf("d_%d\t+\tc_%d_%d\t<\td_%d\n", i, i, e->destination, e->destination);
-                printf("%.3f\t+\t%.3f\t<\t%.3f\n", labels[i], e->weight, labels[e->destination]);
+                // a node already in Q changes the sum of the labels in Q
+                if (lll && ring_contains(Q, dest)) {
+                    queued_sum -= labels[dest];
+                    queued_sum += labels[i] + adj_weight[k];
+                }
 
-                // update the label of e->destination; delays update on the subtree
+                // update the label of dest; delays update on the subtree
                 // to subsequent iteration to speed up the execution
-                labels[e->destination] = labels[i] + e->weight;
+                labels[dest] = labels[i] + adj_weight[k];
 
-                if (predecessors[e->destination] != i) {
-                    predecessors[e->destination] = i;
+                if (predecessors[dest] != i) {
+                    predecessors[dest] = i;
                 }
-                // put e->destination in Q, since its forward edges can violate Bellman
-                if (g_queue_find(Q, GINT_TO_POINTER(e->destination)) == NULL) {
-                    g_queue_push_tail(Q, GINT_TO_POINTER(e->destination));
+                // put dest in Q, since its forward edges can violate Bellman
+                if (!ring_contains(Q, dest)) {
+                    if ((policy == SPTL_PAPE && count_rm[dest] > 0)
+                        || (slf && !ring_is_empty(Q) && labels[dest] < labels[ring_head(Q)])) {
+                        ring_push_head(Q, dest);
+                    }
+                    else {
+                        ring_push_tail(Q, dest);
+                    }
+                    if (lll) {
+                        queued_sum += labels[dest];
+                    }
+                    pushes++;
+                    reinsertions += (count_rm[dest] > 0);
+                    max_queue = MAX(max_queue, Q->count);
                 }
             }
-            // get the next edge in the list
-            adjlist = adjlist->next;
         }
     }
-    g_queue_free(Q);
-    free(count_rm);
-
-    // If there was more than one root (the algorithm ran on a hyper-root)
-    // perform cleanup by removing it from the graph and updating the outputs accordingly
-    for(i = 0; i < G->order; i++) {
-      if(predecessors[i] == root) {
-        predecessors[i] = i;
-      }
+    if (stats) {
+        stats->counted = TRUE;
+        stats->relaxations = relaxations;
+        stats->decreases = decreases;
+        stats->pushes = pushes;
+        stats->pops = count_it;
+        stats->reinsertions = reinsertions;
+        stats->max_queue = max_queue;
+        stats->max_pops = 0;
+        for (i = 0; i < num_vertices; i++) {
+            stats->max_pops = MAX(stats->max_pops, count_rm[i]);
+        }
     }
-    graph_remove_hyper_root(G);
-
     // then returns to the caller the number of iterations performed
     if(neg_cycle) {
       return NO_LOWER_BOUND; // special value returned to signal no lower bound
     }
     return count_it;
 }
+
+// Removes the subtree of v from the preorder thread of the SPT, leaving
+// only v in it: its descendants are marked as out of the tree (their labels
+// are no longer consistent with v's). Returns true if u is v or one of its
+// descendants, that is if the edge u -> v closes a cycle in the SPT
+static bool disassemble_subtree(int v, int u, int *next, int *prev, int *depth, bool *in_tree) {
+    if(u == v) {
+        return true;
+    }
+    int x;
+    for(x = next[v]; x != -1 && depth[x] > depth[v]; x = next[x]) {
+        if(x == u) {
+            return true;
+        }
+        in_tree[x] = false;
+    }
+    // the thread now skips the whole subtree: x is the first vertex after it
+    next[v] = x;
+    if(x != -1) {
+        prev[x] = v;
+    }
+    return false;
+}
+
+int spt_l_tarjan(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  GArray *neg_cycle,
+  SptStats *stats
+) {
+    // multiple roots all start with label 0, as in spt_l
+    int root = g_array_index(roots, int, 0);
+    int num_vertices = G->order;
+
+    // the FIFO queue of the nodes that violate Bellman conditions
+    Ring *Q = ring_new(num_vertices);
+
+    // The SPT is stored as a thread: a doubly linked list of its nodes in
+    // preorder, with the depth of each node, so that the subtree of v is
+    // the run of nodes following v that are deeper than v. With many roots
+    // the SPT is a forest, and the thread links their trees one after the other
+    // Only the roots are in the tree at the beginning: a node enters it when
+    // its label is first lowered, and leaves it when the label of one of its
+    // ancestors is lowered (then it's not scanned until it's lowered again)
+    int *next = (int *)malloc(num_vertices * sizeof(int));
+    int *prev = (int *)malloc(num_vertices * sizeof(int));
+    int *depth = (int *)malloc(num_vertices * sizeof(int));
+    bool *in_tree = (bool *)calloc(num_vertices, sizeof(bool));
+    if(!next || !prev || !depth || !in_tree) {
+        g_error("Failed to alloc the SPT thread");
+    }
+
+    int i;
+    for (i = 0; i < num_vertices; i++) {
+        labels[i] = max_path;
+        predecessors[i] = root;
+    }
+    // the roots are at depth 0 in the thread, in the given order
+    int last = -1;
+    for (i = 0; i < roots->len; i++) {
+        root = g_array_index(roots, int, i);
+        if (in_tree[root]) {
+            continue;
+        }
+        labels[root] = 0;
+        predecessors[root] = root;
+        prev[root] = last;
+        next[root] = -1;
+        if (last != -1) {
+            next[last] = root;
+        }
+        last = root;
+        depth[root] = 0;
+        in_tree[root] = true;
+        ring_push_tail(Q, root);
+    }
+
+    // the counters of the run: stored in stats at the end
+    guint64 relaxations = 0, decreases = 0, pushes = Q->count, pops = 0, reinsertions = 0;
+    int max_queue = Q->count;
+    // the scans of each vertex, counted only for the stats
+    int *scans = NULL;
+    if(stats) {
+        scans = (int *)calloc(num_vertices, sizeof(int));
+        if(!scans) {
+            g_error("Failed to alloc the counters of SPT.L");
+        }
+    }
+
+    int count_it = 0;
+    // the last edge of a negative cycle, if one is found
+    int cycle_u = -1, cycle_v = -1;
+    const int *adj_dest = NULL;
+    const float *adj_weight = NULL;
+    int k, degree, dest;
+
+    while (!ring_is_empty(Q) && cycle_u == -1) {
+        i = ring_pop_head(Q);
+        pops++;
+        // a node whose subtree has been disassembled is not scanned
+        if(!in_tree[i]) {
+            continue;
+        }
+        count_it++;
+        if(scans) {
+            scans[i]++;
+        }
+
+        adj_dest = G->dest + G->offsets[i];
+        adj_weight = G->weight + G->offsets[i];
+        degree = G->offsets[i + 1] - G->offsets[i];
+        relaxations += degree;
+
+        for(k = 0; k < degree && cycle_u == -1; k++) {
+            dest = adj_dest[k];
+
+            if (labels[dest] > labels[i] + adj_weight[k]) {
+                TRACE_VIOLATION(i, dest, adj_weight[k], labels[i], labels[dest]);
+                decreases++;
+
+                if(in_tree[dest]) {
+                    // if i is in the subtree of dest, the edge closes a negative cycle
+                    if(disassemble_subtree(dest, i, next, prev, depth, in_tree)) {
+                        cycle_u = i;
+                        cycle_v = dest;
+                        break;
+                    }
+                    // then dest is unlinked from its parent
+                    // (a root may be the first node of the thread)
+                    if(prev[dest] != -1) {
+                        next[prev[dest]] = next[dest];
+                    }
+                    if(next[dest] != -1) {
+                        prev[next[dest]] = prev[dest];
+                    }
+                }
+                // dest becomes the first child of i
+                next[dest] = next[i];
+                prev[dest] = i;
+                if(next[i] != -1) {
+                    prev[next[i]] = dest;
+                }
+                next[i] = dest;
+                depth[dest] = depth[i] + 1;
+                in_tree[dest] = true;
+
+                // a label already lowered means dest has been queued before
+                if (!ring_contains(Q, dest)) {
+                    ring_push_tail(Q, dest);
+                    pushes++;
+                    reinsertions += (labels[dest] != max_path);
+                    max_queue = MAX(max_queue, Q->count);
+                }
+                labels[dest] = labels[i] + adj_weight[k];
+                predecessors[dest] = i;
+            }
+        }
+    }
+    if (stats) {
+        stats->counted = TRUE;
+        stats->relaxations = relaxations;
+        stats->decreases = decreases;
+        stats->pushes = pushes;
+        stats->pops = pops;
+        stats->reinsertions = reinsertions;
+        stats->max_queue = max_queue;
+        stats->max_pops = 0;
+        for (i = 0; i < num_vertices; i++) {
+            stats->max_pops = MAX(stats->max_pops, scans[i]);
+        }
+        free(scans);
+    }
+
+    // the cycle is dest -> ... -> i -> dest: walk up from i to dest in the SPT
+    if(cycle_u != -1 && neg_cycle) {
+        g_array_set_size(neg_cycle, 0);
+        for(i = cycle_u; i != cycle_v; i = predecessors[i]) {
+            g_array_prepend_val(neg_cycle, i);
+        }
+        g_array_prepend_val(neg_cycle, cycle_v);
+    }
+
+    ring_free(Q);
+    free(next);
+    free(prev);
+    free(depth);
+    free(in_tree);
+
+    if(cycle_u != -1) {
+      return NO_LOWER_BOUND;
+    }
+    return count_it;
+}
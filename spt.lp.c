@@ -0,0 +1,235 @@
+// This file contains a parallel version of Bellman-Ford's algorithm (SPT.L), which
+// processes the whole frontier of improved vertices at each round on many threads
+/*
+ * spt.lp.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// my functions to handle graph reading
+#include "glib-graph.h"
+// the header file where this function is declared
+#include "spt.h"
+// the trace of the relaxations
+#include "trace.h"
+// the threads running the rounds
+#include "team.h"
+// the labels with atomic updates and the frontier
+#include "parallel.h"
+
+#include <glib.h>
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Each round scans the vertices whose label was lowered in the previous one
+ * (the frontier), relaxing their edges in parallel with a compare-and-swap
+ * on the packed labels (see parallel.h). A vertex whose label is lowered is
+ * put in the next frontier by the thread that lowered it, unless it's there
+ * already: a flag per vertex plays the role of the in-queue check of spt_l.
+ * A scan clears the flag of its vertex before reading the label, and a lowering
+ * writes the label before testing the flag, each with a fence between the two:
+ * so either the scan reads the new label or the vertex goes in the next frontier.
+ * Since the labels are updated in place, after round k every shortest path
+ * with at most k edges is known, so without negative cycles the frontier is
+ * empty after |V| rounds at most: a frontier still nonempty after round |V|
+ * proves a negative cycle (as the count of the removals of a vertex in spt_l)
+ */
+
+// The state shared by the threads
+typedef struct lp_shared_t {
+  const CsrGraph *G;
+  PackedLabel *state; // the packed label and predecessor of each vertex
+  atomic_uchar *in_next; // in_next[v] is set iff v is in the next frontier
+  Frontier *frontier;
+  Team *team;
+  GArray **next; // the next frontier of each thread
+  atomic_int scanned; // the vertices scanned
+  int rounds;
+  SptStats *counts; // the counters of each thread: summed in the caller's SptStats at the end
+  int max_frontier; // the largest frontier
+} LpShared;
+
+// The body of each thread of the team
+static void bellman_ford_rounds(int id, int n_threads, gpointer data) {
+  LpShared *s = data;
+  const CsrGraph *G = s->G;
+  GArray *next = s->next[id];
+  SptStats *counts = &s->counts[id];
+  int start, end, i, u, v, k, scanned = 0;
+  float label_u;
+  guint64 old_state;
+
+  frontier_gather(s->frontier, next, id, s->team);
+  while(s->frontier->size > 0 && s->rounds <= G->order) {
+    if(id == 0) {
+      s->max_frontier = MAX(s->max_frontier, s->frontier->size);
+    }
+    while(frontier_next_chunk(s->frontier, &start, &end)) {
+      for(i = start; i < end; i++) {
+        u = s->frontier->items[i];
+        // from now on u goes in the next frontier if it's lowered again
+        // (the fence keeps the load of the label after the clear)
+        atomic_store_explicit(&s->in_next[u], 0, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        label_u = packed_label(atomic_load_explicit(&s->state[u], memory_order_relaxed));
+        scanned++;
+        counts->relaxations += G->offsets[u + 1] - G->offsets[u];
+        for(k = G->offsets[u]; k < G->offsets[u + 1]; k++) {
+          v = G->dest[k];
+          if(packed_lower(&s->state[v], label_u + G->weight[k], u, &old_state)) {
+            TRACE_VIOLATION(u, v, G->weight[k], label_u, packed_label(old_state));
+            counts->decreases++;
+            // (the fence keeps the test of the flag after the lowering)
+            atomic_thread_fence(memory_order_seq_cst);
+            if(!atomic_exchange_explicit(&s->in_next[v], 1, memory_order_relaxed)) {
+              g_array_append_val(next, v);
+              counts->pushes++;
+            }
+          }
+        }
+      }
+    }
+    frontier_gather(s->frontier, next, id, s->team);
+    if(id == 0) {
+      s->rounds++;
+    }
+    team_barrier(s->team);
+  }
+  counts->pops = scanned;
+  atomic_fetch_add(&s->scanned, scanned);
+}
+
+int spt_lp_team(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  Team *team,
+  SptStats *stats
+)
+{
+  Team *own_team = NULL;
+  if (!team)
+  {
+    team = own_team = team_new(g_get_num_processors());
+  }
+  int n_threads = team->n_threads;
+
+  LpShared s;
+  s.G = G;
+  s.team = team;
+  s.frontier = frontier_new(n_threads, roots->len);
+  s.state = (PackedLabel *)malloc(G->order * sizeof(PackedLabel));
+  s.in_next = (atomic_uchar *)malloc(G->order * sizeof(atomic_uchar));
+  s.next = (GArray **)malloc(n_threads * sizeof(GArray *));
+  s.counts = (SptStats *)calloc(n_threads, sizeof(SptStats));
+  if (((!s.state || !s.in_next) && G->order > 0) || !s.next || !s.counts)
+  {
+    g_error("Failed to alloc parallel Bellman-Ford data");
+  }
+  atomic_init(&s.scanned, 0);
+  s.rounds = 0;
+  s.max_frontier = 0;
+
+  // the same initial tree as spt_l: the roots are the first frontier
+  int root = g_array_index(roots, int, 0);
+  int i;
+  for (i = 0; i < G->order; i++)
+  {
+    atomic_init(&s.state[i], pack_label(max_path, root));
+    atomic_init(&s.in_next[i], 0);
+  }
+  for (i = 0; i < n_threads; i++)
+  {
+    s.next[i] = g_array_new(FALSE, FALSE, sizeof(int));
+  }
+  for (i = 0; i < roots->len; i++)
+  {
+    root = g_array_index(roots, int, i);
+    if (!atomic_load(&s.in_next[root]))
+    {
+      atomic_store(&s.state[root], pack_label(0.0, root));
+      atomic_store(&s.in_next[root], 1);
+      g_array_append_val(s.next[0], root);
+      s.counts[0].pushes++;
+    }
+  }
+
+  team_run(team, bellman_ford_rounds, &s);
+
+  // the frontier is not empty only if the rounds stopped because of a negative cycle
+  gboolean neg_cycle = (s.frontier->size > 0);
+
+  guint64 packed;
+  int reached = 0;
+  for (i = 0; i < G->order; i++)
+  {
+    packed = atomic_load(&s.state[i]);
+    labels[i] = packed_label(packed);
+    predecessors[i] = packed_pred(packed);
+    reached += (labels[i] != max_path);
+  }
+
+  if (stats)
+  {
+    memset(stats, 0, sizeof(SptStats));
+    for (i = 0; i < n_threads; i++)
+    {
+      stats->relaxations += s.counts[i].relaxations;
+      stats->decreases += s.counts[i].decreases;
+      stats->pushes += s.counts[i].pushes;
+      stats->pops += s.counts[i].pops;
+    }
+    // every vertex reached is scanned at least once: the other scans
+    // follow a reinsertion in the frontier
+    stats->counted = TRUE;
+    stats->reinsertions = (stats->pops > reached ? stats->pops - reached : 0);
+    stats->max_queue = s.max_frontier;
+  }
+
+  for (i = 0; i < n_threads; i++)
+  {
+    g_array_free(s.next[i], TRUE);
+  }
+  free(s.next);
+  free(s.counts);
+  free((void *)s.state);
+  free((void *)s.in_next);
+  frontier_free(s.frontier);
+  team_free(own_team);
+
+  if (neg_cycle)
+  {
+    return NO_LOWER_BOUND;
+  }
+  return atomic_load(&s.scanned);
+}
+
+int spt_lp(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors
+)
+{
+  return spt_lp_team(G, roots, max_path, labels, predecessors, NULL, NULL);
+}
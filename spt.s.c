@@ -1,5 +1,6 @@
 // Finds the SPT of a weighted directed graph G = (V, E) using Dijkstra's algorithm
-// The time complexity is O(|V|^2) if and only if all weights are positive
+// The priority queue is an indexed d-ary heap (see heap.h), so the time complexity
+// is O(|E| log |V|) if and only if all weights are positive
 // It will NOT terminate if there are negative cycles in the graph (use spt_l)
 
 /*
@@ -26,223 +27,345 @@
 #include "glib-graph.h"
 // the header file where this function is declared
 #include "spt.h"
+// the trace of the relaxations
+#include "trace.h"
+// the priority queues
+#include "heap.h"
+#include "bucket.h"
 
 #include <glib.h> // Glib header for data structures (GList, GQueue, ...)
 
 #include <stdio.h>
 #include <stdlib.h>
 
-// A q_element is the function's representation of a node in the SPT:
-struct q_element
-{
-    int vertex;      // the node's identifier
-    int predecessor; // the node's predecessor in the current SPT
-    float label;     // the cost of the shortest path from root to vertex
-};
-typedef struct q_element *Element;
-
-// GComparisonFunc to compute the relative priority of Elements
-// the priority in this context is given by its label field: an element with lower
-// label must come before another with a higher label
-// The user_data parameter is just ignored
-gint smallest_label(gconstpointer a, gconstpointer b, gpointer user_data)
-{
-    Element pa = (Element)a;
-    Element pb = (Element)b;
-    if (pa->label < pb->label)
-    {
-        return -1;
-    }
-    if (pa->label > pb->label)
-    {
-        return 1;
-    }
-    return 0;
-}
-
-// spt_l applies Dijkstra on the graph G based on the list of roots
+// spt_s applies Dijkstra on the graph G based on the list of roots
 // and outputs the labels and predecessors arrays that represent (one of)
 // the shortest paths tree
+// The labels and predecessors are kept directly in the caller's arrays,
+// so the only allocation is the heap
 int spt_s(
-  Graph *G,
+  const CsrGraph *G,
   GArray *roots,
   float max_path,
   float *labels,
   int *predecessors
 )
 {
-  // The algorithm supports multiple roots, by adding a node connected to all
-  // the roots with weigth 0 and applying the procedure on the modified graph
-  // and the new node as the root of the spt. Afterwards, the node is removed
-  int root;
-  if(roots->len > 1) {
-    root = graph_add_hyper_root(G, roots);
-  }
-  else {
-    root = g_array_index(roots, int, 0);
-  }
-
-#ifdef DEBUG // prints the modified graph
-    puts("GRAPH");
-    print_graph(stdout, *G);
-#endif
-
   // SPT.S implements the set Q as a priority queue
-  // a list ordered by the smallest label of its elements
-  GQueue *Q = g_queue_new();
+  // ordered by the smallest label of its vertices
+  Heap *Q = heap_new(G->order);
+  int count_it = spt_s_heap(G, roots, max_path, labels, predecessors, Q, NULL);
+  heap_free(Q);
+  // then returns to the caller the number of iterations needed to find the SPT
+  return count_it;
+}
 
+int spt_s_heap(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  Heap *Q,
+  SptStats *stats
+)
+{
+  // The algorithm supports multiple roots: all of them start with label 0
+  // and are put in Q, so the graph is never modified
+  int root = g_array_index(roots, int, 0);
   int i;
-  // alloc an array of elements:
-  // any vertex of the |V| vertices can be inserted in the queue,
-  // so it's handy to reserve space in advance
-  Element *vertices = (Element *)malloc(G->order * sizeof(Element));
-  if (vertices == NULL)
-  {
-      g_error("Failed to alloc elements array");
-  }
+  // An initial tree is needed to start the algorithm; a simple way to obtain such
+  // a tree is to connect all nodes to the root with max_w as their edge weight
+  // so that this edge will always violate Bellman conditions
   for (i = 0; i < G->order; i++)
   {
-      vertices[i] = (struct q_element *)malloc(sizeof(struct q_element));
-      if (vertices[i] == NULL)
-      {
-          g_error("Failed to alloc queue element");
-      }
-
-      // An initial tree is needed to start the algorithm; a simple way to obtain such
-      // a tree is to connect all nodes to the root with max_w as their edge weight
-      // so that this edge will always violate Bellman conditions
-      if (i != root)
-      {
-          vertices[i]->label = max_path;
-      }
-      else
-      {
-          vertices[root]->label = 0.0; // root's label is set to 0 as obvious
-      }
-      vertices[i]->vertex = i;
-      vertices[i]->predecessor = root; // all nodes have root as their predecessor
+    labels[i] = max_path;
+    predecessors[i] = root; // all nodes have root as their predecessor
   }
 
+  // the counters of the run: stored in stats at the end
+  guint64 relaxations = 0, decreases = 0, pushes = 0, reinsertions = 0;
+  int max_queue = 0;
+
   // Q is initialized with all the tail nodes of those edges violating
-  // bellman conditions; only root meets these conditions at initialization
-  g_queue_push_head(Q, (void *)vertices[root]);
-  // the data must be stored as a gpointer (just a fancy void*)
+  // bellman conditions; only the roots meet these conditions at initialization
+  // Each root gets label 0 and is its own predecessor (repeated roots are skipped)
+  heap_clear(Q);
+  for (i = 0; i < roots->len; i++)
+  {
+    root = g_array_index(roots, int, i);
+    if (labels[root] != 0.0 || predecessors[root] != root)
+    {
+      labels[root] = 0.0;
+      predecessors[root] = root;
+      heap_push(Q, root, 0.0);
+      pushes++;
 
 #ifdef DEBUG // prints the insertion of root in Q
-  g_print("Put\n\tvertex: %d\n\tlabel: %f\n\tpred: %d\n",
-          vertices[root]->vertex,
-          vertices[root]->label,
-          vertices[root]->predecessor);
+      g_print("Put\n\tvertex: %d\n\tlabel: %f\n\tpred: %d\n", root, labels[root], predecessors[root]);
 #endif
+    }
+  }
+
+  max_queue = Q->size;
 
   // Counts the number of iterations made by the algorithm
   int count_it = 0;
   // Other dummy variables
-  Edge *e = NULL;
-  GList *dummy_list = NULL;
-  GSList *adjlist = NULL;
-  Element u = 0;
+  const int *adj_dest = NULL;
+  const float *adj_weight = NULL;
+  int u, k, degree, dest;
+  float label;
 
   // while Q is not empty, iterate
-  while (!g_queue_is_empty(Q))
+  while (!heap_is_empty(Q))
   {
     count_it++;
 
     // in Dijkstra (SPT.S) Q is a priority queue, so the element with the highest
-    // priority is the head of the list at each iteration.
-    u = (Element)g_queue_pop_head(Q);
-    // the cast is needed to convert from gpointer
+    // priority (the smallest label) is extracted at each iteration.
+    u = heap_pop(Q, NULL);
 
 #ifdef DEBUG // prints the extacted vertex
-    g_print("Extracted\n\tvertex: %d\n\tlabel: %f\n\tpred: %d\n",
-            u->vertex,
-            u->label,
-            u->predecessor);
+    g_print("Extracted\n\tvertex: %d\n\tlabel: %f\n\tpred: %d\n", u, labels[u], predecessors[u]);
 #endif
 
     // Check bellman conditions of the forward edges from u
 
-    // get i's adjacency list
-    // TODO: Replace with the correct call to g_list_find_custom to find
-    // the i-th vertex's adjacency list
-    dummy_list = G->nodes;
-    while(dummy_list && ((Node *)dummy_list->data)->vertex != u->vertex) {
-      dummy_list = dummy_list->next;
-    }
-    adjlist = ((Node *)dummy_list->data)->adjacent;
-
-#ifdef DEBUG // prints the adjacency list of node i
-    g_print("Node %d\'s adjacency list:\n[\n", ((Node *)dummy_list->data)->vertex);
-    GSList *ss = adjlist;
-    while(ss) {
-      Edge *ee = ss->data;
-      g_print("\t{dest = %d, weight = %.3f} ->\n", ee->destination, ee->weight);
-      ss = ss->next;
+    // get u's adjacency list: a slice of the CSR arrays
+    adj_dest = G->dest + G->offsets[u];
+    adj_weight = G->weight + G->offsets[u];
+    degree = G->offsets[u + 1] - G->offsets[u];
+    relaxations += degree;
+
+#ifdef DEBUG // prints the adjacency list of node u
+    g_print("Node %d\'s adjacency list:\n[\n", u);
+    for (k = 0; k < degree; k++) {
+      g_print("\t{dest = %d, weight = %.3f} ->\n", adj_dest[k], adj_weight[k]);
     }
     g_print("\tNULL\n]\n");
 #endif
 
-    // Iterate over all the elements in the list
-    while (adjlist != NULL)
+    // Iterate over all the edges in the list
+    for (k = 0; k < degree; k++)
     {
-      e = (Edge *)adjlist->data;
-      // edge (u, e->destination) satisfies the Bellman condition?
-      if (vertices[u->vertex]->label + e->weight < vertices[e->destination]->label)
+      dest = adj_dest[k];
+      label = labels[u] + adj_weight[k];
+      // edge (u, dest) satisfies the Bellman condition?
+      if (label < labels[dest])
       {
-        printf("(%d, %d) violates Bellman\n", u->vertex, e->destination);
-        printf("d_%d\t+\tc_%d_%d\t<\td_%d\n", u->vertex, u->vertex, e->destination, e->destination);
-        printf("%.3f\t+\t%.3f\t<\t%.3f\n", vertices[u->vertex]->label, e->weight, vertices[e->destination]->label);
-
-        // update the label of e->destination; delays update on the subtree
-        // to subsequent iteration to speed up the execution
-        vertices[e->destination]->label = vertices[u->vertex]->label + e->weight;
+        TRACE_VIOLATION(u, dest, adj_weight[k], labels[u], labels[dest]);
 
-        if (vertices[e->destination]->predecessor != u->vertex)
-        {
-          vertices[e->destination]->predecessor = u->vertex;
-        }
-        // if the vertex e->destination is not in the prioqueue
-        // inserts it while maintaining the queue sorted by lowest label
-        if (g_queue_find(Q, (void *)vertices[e->destination]) == NULL)
+        decreases++;
+        if (!heap_contains(Q, dest))
         {
-          // inserts maintaining sorting by priority (calls smallest_label to compare)
-          g_queue_insert_sorted(Q, (void *)vertices[e->destination], smallest_label, NULL);
-
+          // a vertex out of Q with a label has already been extracted
+          // (possible only with negative weights)
+          pushes++;
+          reinsertions += (labels[dest] != max_path);
 #ifdef DEBUG
-          g_print("Put\n\tvertex: %d\n\tlabel: %f\n\tpred: %d\n",
-                  vertices[e->destination]->vertex,
-                  vertices[e->destination]->label,
-                  vertices[e->destination]->predecessor);
+          g_print("Put\n\tvertex: %d\n\tlabel: %f\n\tpred: %d\n", dest, label, u);
 #endif
         }
+        labels[dest] = label;
+        predecessors[dest] = u;
+        // if the vertex dest is already in the prioqueue its position is
+        // updated to the new label (decrease-key), otherwise it's inserted
+        heap_push_or_decrease(Q, dest, label);
+        max_queue = MAX(max_queue, Q->size);
       }
+    }
+  }
+
+  if (stats)
+  {
+    stats->counted = TRUE;
+    stats->relaxations = relaxations;
+    stats->decreases = decreases;
+    stats->pushes = pushes;
+    stats->pops = count_it;
+    stats->reinsertions = reinsertions;
+    stats->max_queue = max_queue;
+    // every vertex is scanned once, at its final label
+    stats->max_pops = (count_it > 0 ? 1 : 0);
+  }
+  return count_it;
+}
+
+int spt_s_monotone(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors,
+  SptsMonotone kind,
+  SptStats *stats
+)
+{
+  if (kind == DIAL_QUEUE && !(G->min_weight > 0.0))
+  {
+    g_error("The Dial queue needs all the edge weights to be positive");
+  }
+  if (kind == RADIX_HEAP && G->min_weight < 0.0)
+  {
+    g_error("The radix heap needs all the edge weights to be non-negative");
+  }
+  // multiple roots all start with label 0, as in spt_s
+  int root = g_array_index(roots, int, 0);
+  int num_vertices = G->order;
 
-      // gets the next edge in this node's adjacency list
-      adjlist = adjlist->next;
+  // the initial tree connects all nodes to the root with edges of weight max_path
+  int i;
+  for (i = 0; i < num_vertices; i++)
+  {
+    labels[i] = max_path;
+    predecessors[i] = root;
+  }
+
+  // only one of the queues is used, depending on kind
+  DialQueue *dial = NULL;
+  RadixHeap *radix = NULL;
+  if (kind == DIAL_QUEUE)
+  {
+    dial = dial_new(num_vertices, G->min_weight, G->max_weight);
+  }
+  else
+  {
+    radix = radix_new();
+  }
+  // the counters of the run: stored in stats at the end
+  // (the radix heap has no decrease-key, so each lowered label is a push)
+  guint64 relaxations = 0, decreases = 0, pushes = 0, pops = 0, reinsertions = 0;
+  int max_queue = 0;
+
+  // the roots are put in the queue (once each)
+  for (i = 0; i < roots->len; i++)
+  {
+    root = g_array_index(roots, int, i);
+    if (labels[root] != 0.0 || predecessors[root] != root)
+    {
+      labels[root] = 0.0;
+      predecessors[root] = root;
+      if (kind == DIAL_QUEUE)
+      {
+        dial_push(dial, root, 0.0);
+      }
+      else
+      {
+        radix_push(radix, root, 0.0);
+      }
+      pushes++;
     }
   }
-  g_queue_free(Q);
+  max_queue = (kind == DIAL_QUEUE ? dial->count : radix->size);
+
+  int count_it = 0;
+  const int *adj_dest = NULL;
+  const float *adj_weight = NULL;
+  int u, k, degree, dest;
+  float key;
 
-  // If there was more than one root (the algorithm ran on a hyper-root)
-  // perform cleanup by removing it from the graph and updating the outputs accordingly
-  for(i = 0; i < G->order; i++) {
-    if(vertices[i]->predecessor == root) {
-      vertices[i]->predecessor = i;
+  while (kind == DIAL_QUEUE ? !dial_is_empty(dial) : !radix_is_empty(radix))
+  {
+    pops++;
+    if (kind == DIAL_QUEUE)
+    {
+      u = dial_pop(dial);
+    }
+    else
+    {
+      u = radix_pop(radix, &key);
+      // the radix heap has no decrease-key: skip the entries of u
+      // pushed before its label was lowered
+      if (key != labels[u])
+      {
+        continue;
+      }
+    }
+    count_it++;
+
+    // get u's adjacency list: a slice of the CSR arrays
+    adj_dest = G->dest + G->offsets[u];
+    adj_weight = G->weight + G->offsets[u];
+    degree = G->offsets[u + 1] - G->offsets[u];
+    relaxations += degree;
+
+    for (k = 0; k < degree; k++)
+    {
+      dest = adj_dest[k];
+      if (labels[u] + adj_weight[k] < labels[dest])
+      {
+        TRACE_VIOLATION(u, dest, adj_weight[k], labels[u], labels[dest]);
+
+        decreases++;
+        if (kind == DIAL_QUEUE)
+        {
+          // a vertex out of the queue with a label has already been extracted
+          if (dial->bucket[dest] == NO_BUCKET)
+          {
+            pushes++;
+            reinsertions += (labels[dest] != max_path);
+          }
+          labels[dest] = labels[u] + adj_weight[k];
+          predecessors[dest] = u;
+          dial_push(dial, dest, labels[dest]);
+          max_queue = MAX(max_queue, dial->count);
+        }
+        else
+        {
+          pushes++;
+          labels[dest] = labels[u] + adj_weight[k];
+          predecessors[dest] = u;
+          radix_push(radix, dest, labels[dest]);
+          max_queue = MAX(max_queue, radix->size);
+        }
+      }
     }
-    
-    // Copy the resulting spt in the given arrays as well
-    labels[i] = vertices[i]->label;
-    predecessors[i] = vertices[i]->predecessor;
   }
-  graph_remove_hyper_root(G);
 
-  // and then free the array of Elements
-  for (i = 0; i < G->order; i++)
+  if (stats)
   {
-    free(vertices[i]);
+    stats->counted = TRUE;
+    stats->relaxations = relaxations;
+    stats->decreases = decreases;
+    stats->pushes = pushes;
+    stats->pops = pops;
+    stats->reinsertions = reinsertions;
+    stats->max_queue = max_queue;
+    // every vertex is scanned once, at its final label
+    stats->max_pops = (count_it > 0 ? 1 : 0);
+  }
+
+  if (kind == DIAL_QUEUE)
+  {
+    dial_free(dial);
+  }
+  else
+  {
+    radix_free(radix);
   }
-  free(vertices);
 
-  // then returns to the caller the number of iterations needed to find the SPT
   return count_it;
 }
+
+int spt_s_dial(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors
+)
+{
+  return spt_s_monotone(G, roots, max_path, labels, predecessors, DIAL_QUEUE, NULL);
+}
+
+int spt_s_radix(
+  const CsrGraph *G,
+  GArray *roots,
+  float max_path,
+  float *labels,
+  int *predecessors
+)
+{
+  return spt_s_monotone(G, roots, max_path, labels, predecessors, RADIX_HEAP, NULL);
+}
@@ -0,0 +1,150 @@
+// This file contains the index of an SPT: children lists, preorder tour, paths and subtrees
+/*
+ * spt.tree.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header file where these functions are declared
+#include "spt.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+
+SptTree* spt_tree_new(int order, const float *labels, const int *predecessors, float max_path) {
+  SptTree *T = (SptTree *)malloc(sizeof(SptTree));
+  if(!T) {
+    g_error("SptTree can't be alloc'd");
+  }
+  T->order = order;
+  T->predecessors = predecessors;
+  T->child_offsets = (int *)calloc(order + 1, sizeof(int));
+  T->children = (int *)malloc(order * sizeof(int));
+  T->tour = (int *)malloc(order * sizeof(int));
+  T->enter = (int *)malloc(order * sizeof(int));
+  T->leave = (int *)malloc(order * sizeof(int));
+  T->depth = (int *)malloc(order * sizeof(int));
+  T->root = (int *)malloc(order * sizeof(int));
+  if(!T->child_offsets || ((!T->children || !T->tour || !T->enter || !T->leave
+                            || !T->depth || !T->root) && order > 0)) {
+    g_error("Failed to alloc the SPT index");
+  }
+
+  // the children of each reached vertex, in increasing order (counting sort
+  // on the predecessors: child_offsets[u + 1] first counts the children of u,
+  // then child_offsets[u] is the next free slot of u and is shifted back)
+  int v, u, i, k, top;
+  for(v = 0; v < order; v++) {
+    T->enter[v] = T->leave[v] = T->depth[v] = T->root[v] = -1;
+    if(labels[v] < max_path && predecessors[v] != v) {
+      T->child_offsets[predecessors[v] + 1]++;
+    }
+  }
+  for(u = 0; u < order; u++) {
+    T->child_offsets[u + 1] += T->child_offsets[u];
+  }
+  for(v = 0; v < order; v++) {
+    if(labels[v] < max_path && predecessors[v] != v) {
+      T->children[T->child_offsets[predecessors[v]]++] = v;
+    }
+  }
+  for(u = order; u > 0; u--) {
+    T->child_offsets[u] = T->child_offsets[u - 1];
+  }
+  T->child_offsets[0] = 0;
+
+  // the preorder tour from each root (its own predecessor), in increasing order
+  // The stack holds each vertex at most once, so it's kept in the leave
+  // array until the sizes are computed
+  int *stack = T->leave;
+  int n = 0;
+  for(v = 0; v < order; v++) {
+    if(labels[v] >= max_path || predecessors[v] != v) {
+      continue;
+    }
+    T->depth[v] = 0;
+    T->root[v] = v;
+    stack[0] = v;
+    top = 1;
+    while(top > 0) {
+      u = stack[--top];
+      T->enter[u] = n;
+      T->tour[n++] = u;
+      // the children are pushed last to first, so they're visited in order
+      for(k = T->child_offsets[u + 1] - 1; k >= T->child_offsets[u]; k--) {
+        i = T->children[k];
+        T->depth[i] = T->depth[u] + 1;
+        T->root[i] = v;
+        stack[top++] = i;
+      }
+    }
+  }
+  T->n_reached = n;
+
+  // the size of each subtree, from the leaves up (the tour in reverse
+  // visits every vertex after its descendants): leave = enter + size
+  for(v = 0; v < order; v++) {
+    T->leave[v] = (T->enter[v] == -1 ? -1 : 1);
+  }
+  for(i = n - 1; i >= 0; i--) {
+    v = T->tour[i];
+    if(predecessors[v] != v) {
+      T->leave[predecessors[v]] += T->leave[v];
+    }
+  }
+  for(i = 0; i < n; i++) {
+    v = T->tour[i];
+    T->leave[v] += T->enter[v];
+  }
+  return T;
+}
+
+int spt_tree_path(const SptTree *T, int v, GArray *path) {
+  if(T->enter[v] == -1) {
+    g_array_set_size(path, 0);
+    return -1;
+  }
+  // the depth gives the length of the path, so it's filled backwards in one walk
+  int i, edges = T->depth[v];
+  g_array_set_size(path, edges + 1);
+  for(i = edges; i >= 0; i--) {
+    g_array_index(path, int, i) = v;
+    v = T->predecessors[v];
+  }
+  return edges;
+}
+
+const int* spt_tree_subtree(const SptTree *T, int v, int *size) {
+  if(T->enter[v] == -1) {
+    *size = 0;
+    return NULL;
+  }
+  *size = T->leave[v] - T->enter[v];
+  return T->tour + T->enter[v];
+}
+
+void spt_tree_free(SptTree *T) {
+  free(T->child_offsets);
+  free(T->children);
+  free(T->tour);
+  free(T->enter);
+  free(T->leave);
+  free(T->depth);
+  free(T->root);
+  free(T);
+}
@@ -0,0 +1,160 @@
+// A persistent team of threads running the same function, with a barrier
+/*
+ * team.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "team.h"
+
+#include <glib.h>
+
+#include <stdlib.h>
+
+// the arguments of each thread of the team
+typedef struct member_t {
+  Team *team;
+  int id;
+} Member;
+
+// The body of threads 1 .. n_threads - 1: runs each job given to the team
+static gpointer team_member(gpointer arg) {
+  Member *m = arg;
+  Team *t = m->team;
+  guint seen = 0; // the last job run by this thread
+  TeamFunc func;
+  gpointer data;
+  while(TRUE) {
+    g_mutex_lock(&t->lock);
+    while(t->job == seen && !t->quit) {
+      g_cond_wait(&t->start, &t->lock);
+    }
+    if(t->quit) {
+      g_mutex_unlock(&t->lock);
+      break;
+    }
+    seen = t->job;
+    func = t->func;
+    data = t->data;
+    g_mutex_unlock(&t->lock);
+
+    func(m->id, t->n_threads, data);
+
+    g_mutex_lock(&t->lock);
+    t->running--;
+    if(t->running == 0) {
+      g_cond_signal(&t->done);
+    }
+    g_mutex_unlock(&t->lock);
+  }
+  free(m);
+  return NULL;
+}
+
+Team* team_new(int n_threads) {
+  Team *t = (Team *)malloc(sizeof(Team));
+  if(!t) {
+    g_error("Team can't be alloc'd");
+  }
+  t->n_threads = MAX(n_threads, 1);
+  t->threads = (GThread **)malloc(t->n_threads * sizeof(GThread *));
+  if(!t->threads) {
+    g_error("Team threads can't be alloc'd");
+  }
+  g_mutex_init(&t->lock);
+  g_cond_init(&t->start);
+  g_cond_init(&t->done);
+  g_cond_init(&t->barrier);
+  t->job = 0;
+  t->running = 0;
+  t->quit = FALSE;
+  t->func = NULL;
+  t->data = NULL;
+  t->arrived = 0;
+  t->phase = 0;
+  int i;
+  for(i = 1; i < t->n_threads; i++) {
+    Member *m = (Member *)malloc(sizeof(Member));
+    if(!m) {
+      g_error("Team member can't be alloc'd");
+    }
+    m->team = t;
+    m->id = i;
+    t->threads[i] = g_thread_new("spt-team", team_member, m);
+  }
+  return t;
+}
+
+void team_run(Team *t, TeamFunc func, gpointer data) {
+  g_mutex_lock(&t->lock);
+  t->func = func;
+  t->data = data;
+  t->running = t->n_threads - 1;
+  t->job++;
+  g_cond_broadcast(&t->start);
+  g_mutex_unlock(&t->lock);
+
+  func(0, t->n_threads, data);
+
+  g_mutex_lock(&t->lock);
+  while(t->running > 0) {
+    g_cond_wait(&t->done, &t->lock);
+  }
+  g_mutex_unlock(&t->lock);
+}
+
+void team_barrier(Team *t) {
+  if(t->n_threads == 1) {
+    return;
+  }
+  g_mutex_lock(&t->lock);
+  guint phase = t->phase;
+  t->arrived++;
+  if(t->arrived == t->n_threads) {
+    // the last thread to arrive releases the others
+    t->arrived = 0;
+    t->phase++;
+    g_cond_broadcast(&t->barrier);
+  }
+  else {
+    while(phase == t->phase) {
+      g_cond_wait(&t->barrier, &t->lock);
+    }
+  }
+  g_mutex_unlock(&t->lock);
+}
+
+void team_free(Team *t) {
+  if(!t) {
+    return;
+  }
+  g_mutex_lock(&t->lock);
+  t->quit = TRUE;
+  g_cond_broadcast(&t->start);
+  g_mutex_unlock(&t->lock);
+  int i;
+  for(i = 1; i < t->n_threads; i++) {
+    g_thread_join(t->threads[i]);
+  }
+  g_mutex_clear(&t->lock);
+  g_cond_clear(&t->start);
+  g_cond_clear(&t->done);
+  g_cond_clear(&t->barrier);
+  free(t->threads);
+  free(t);
+}
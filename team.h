@@ -0,0 +1,60 @@
+// A persistent team of threads running the same function, with a barrier (header file)
+/*
+ * team.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEAM_DEFINED
+#define TEAM_DEFINED
+
+#include <glib.h>
+
+// The function run by every thread of the team: id goes from 0 to n_threads - 1
+typedef void (*TeamFunc)(int id, int n_threads, gpointer data);
+
+// The threads are started once by team_new and wait for the jobs given
+// by team_run, so that an algorithm with many parallel phases doesn't pay
+// for creating threads: the phases are separated by team_barrier instead
+typedef struct team_t {
+  int n_threads; // including the thread calling team_run
+  GThread **threads; // threads[0] is unused (the caller is thread 0)
+  GMutex lock;
+  GCond start; // signaled when a job is given (or the team is freed)
+  GCond done; // signaled when the last thread completes a job
+  guint job; // incremented by each team_run
+  int running; // the threads still working on the current job
+  gboolean quit;
+  TeamFunc func;
+  gpointer data;
+  // the barrier
+  GCond barrier;
+  int arrived; // the threads waiting at the barrier
+  guint phase; // incremented each time all the threads reach the barrier
+} Team;
+
+// creates a team of n_threads threads (at least 1): n_threads - 1 are started
+Team* team_new(int n_threads);
+// runs func on all the threads of the team (the caller is thread 0)
+// and returns when all of them have returned
+void team_run(Team *t, TeamFunc func, gpointer data);
+// called by all the threads of a job: waits until all of them have called it
+void team_barrier(Team *t);
+// stops and joins the threads
+void team_free(Team *t);
+
+#endif
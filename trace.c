@@ -0,0 +1,44 @@
+// Trace of the edges that violate Bellman's condition during the algorithms
+/*
+ * trace.c
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the header containing the declarations
+#include "trace.h"
+
+#include <stdio.h>
+
+TraceSink trace_sink = NULL;
+void *trace_data = NULL;
+
+void trace_set_sink(TraceSink sink, void *data) {
+  trace_sink = sink;
+  trace_data = data;
+}
+
+void trace_print(const TraceEvent *ev, void *data) {
+  FILE *out = (FILE *)data;
+  // a single call: stdio locks the stream for each call, so the events
+  // printed by the threads of the parallel solvers don't interleave
+  fprintf(out, "(%d, %d) violates Bellman\n"
+               "d_%d\t+\tc_%d_%d\t<\td_%d\n"
+               "%.3f\t+\t%.3f\t<\t%.3f\n",
+          ev->u, ev->v, ev->u, ev->u, ev->v, ev->v,
+          ev->label_u, ev->weight, ev->label_v);
+}
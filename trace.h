@@ -0,0 +1,70 @@
+// Trace of the edges that violate Bellman's condition during the algorithms (header file)
+/*
+ * trace.h
+ * This file is part of spt
+ *
+ * Copyright (C) 2021 - etrian-dev
+ *
+ * spt is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * spt is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with spt. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_DEFINED
+#define TRACE_DEFINED
+
+#include <glib.h>
+
+#include <stdio.h>
+
+// An edge (u, v) of weight w found to violate Bellman's condition,
+// that is label_u + weight < label_v (the labels before v is updated)
+typedef struct trace_event_t {
+  int u;
+  int v;
+  float weight;
+  float label_u;
+  float label_v;
+} TraceEvent;
+
+// A sink receives every event, along with the data given to trace_set_sink
+// The parallel solvers (delta-stepping and parallel Bellman-Ford) call it from
+// all their threads at once, so it must be thread-safe
+typedef void (*TraceSink)(const TraceEvent *ev, void *data);
+
+// the current sink: NULL (the default) disables the trace
+extern TraceSink trace_sink;
+extern void *trace_data;
+
+// Sets the sink of the trace (NULL to disable it)
+void trace_set_sink(TraceSink sink, void *data);
+
+// A sink printing each event on the FILE* in data, in the format of the DEBUG build
+// (each event is written at once, so it's thread-safe)
+void trace_print(const TraceEvent *ev, void *data);
+
+// Reports the violation of Bellman's condition on (u, v) to the sink, if any:
+// when the trace is disabled this costs a single (predicted) branch, and
+// compiling with -D SPT_NO_TRACE removes even that
+#ifdef SPT_NO_TRACE
+#define TRACE_VIOLATION(u, v, w, label_u, label_v) do { } while(0)
+#else
+#define TRACE_VIOLATION(u, v, w, label_u, label_v) \
+  do { \
+    if(G_UNLIKELY(trace_sink != NULL)) { \
+      TraceEvent ev_ = {(u), (v), (w), (label_u), (label_v)}; \
+      trace_sink(&ev_, trace_data); \
+    } \
+  } while(0)
+#endif
+
+#endif